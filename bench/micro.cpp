@@ -0,0 +1,385 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "config.h"
+#include "chess/Board.hpp"
+#include "chess/LegalMoveCache.h"
+#include "engine/GameStore.h"
+
+namespace bench
+{
+    struct BoardAccess
+    {
+        using bitboard_t = chess::Board::bitboard_t;
+
+        static bitboard_t lineAttacks(chess::File f, chess::Rank r, bitboard_t occupancy)
+        {
+            return chess::Board::lineAttacks(occupancy, chess::Board::s_fileRays[std::to_underlying(f)][std::to_underlying(r)]);
+        }
+
+        static bitboard_t rookMoves(chess::File f, chess::Rank r, bitboard_t occupancy) { return chess::Board::rookMoves(f, r, occupancy); }
+
+        static bitboard_t bishopMoves(chess::File f, chess::Rank r, bitboard_t occupancy) { return chess::Board::bishopMoves(f, r, occupancy); }
+
+        static bitboard_t all(const chess::Board &board) { return board.all(); }
+
+        template<chess::Color C>
+        static bitboard_t attackedBy(const chess::Board &board, chess::File f, chess::Rank r) { return board.attackedBy<C>(f, r); }
+
+        template<chess::Color C>
+        static bool inCheck(const chess::Board &board) { return board.inCheck<C>(); }
+
+        // Always rebuilds the map, so every pass pays for it once like the first query after a move would.
+        template<chess::Color C>
+        static bitboard_t attackMap(const chess::Board &board)
+        {
+            board.computeAttacks<C>();
+            return board.attackMap<C>();
+        }
+
+        static chess::Color turn(const chess::Board &board) { return board.m_turn; }
+
+        static chess::Piece piece(const chess::Board &board, chess::File f, chess::Rank r) { return board.piece(chess::Board::square(f, r)); }
+
+        static bitboard_t moves(const chess::Board &board, chess::Piece p, chess::File f, chess::Rank r) { return board.moves(p, f, r); }
+    };
+} // namespace bench
+
+namespace
+{
+    using chess::File;
+    using chess::Rank;
+    using bitboard_t = bench::BoardAccess::bitboard_t;
+
+    // Fixed corpus, every benchmark walks all of it so results stay comparable across commits.
+    // Each position comes with one move that Board::move accepts.
+    struct Position
+    {
+        const char *fen;
+        const char *move;
+    };
+
+    constexpr const Position s_corpus[] = {
+            {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",                 "e2e4"},
+            {"rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1",              "c7c5"},
+            {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",     "e5f7"},
+            {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",                                "e2e4"},
+            {"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",                "d7c8q"},
+            {"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", "c3d5"},
+            {"r1bq1rk1/pp2nppp/2n1p3/3pP3/2pP4/P1P2N2/2P2PPP/R1BQKB1R b KQ - 1 9",      "f7f6"},
+            {"8/8/4k3/3p4/3P4/4K3/8/8 w - - 0 1",                                        "e3f4"},
+    };
+
+    constexpr const int s_samples = 30;
+    constexpr const double s_sampleSeconds = 0.01;
+    constexpr const double s_warmupSeconds = 0.05;
+
+    // Keeps a value alive without the compiler being able to fold the work that produced it.
+    template<typename T>
+    inline void doNotOptimize(const T &value) { asm volatile("" : : "r,m"(value) : "memory"); }
+
+    inline std::uint64_t cycles()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc(); // Reference cycles at the TSC rate, not core clock cycles under turbo.
+#else
+        return 0;
+#endif
+    }
+
+    struct Measurement
+    {
+        std::string name;
+        std::uint64_t iterations;   // Passes per sample.
+        std::uint64_t opsPerPass;
+        double nsMean, nsMedian, nsCi95;
+        double cyclesMean;
+    };
+
+    // A pass runs the operation over the whole corpus and returns how many operations it performed.
+    // Passes per sample are calibrated once so a sample lasts about s_sampleSeconds.
+    Measurement measure(const std::string &name, const std::function<std::uint64_t()> &pass)
+    {
+        using clock = std::chrono::steady_clock;
+
+        std::uint64_t opsPerPass = 0;
+        std::uint64_t passes = 0;
+        const auto warmupStart = clock::now();
+        do
+        {
+            opsPerPass = pass();
+            passes++;
+        } while (std::chrono::duration<double>(clock::now() - warmupStart).count() < s_warmupSeconds);
+
+        const double secondsPerPass = std::chrono::duration<double>(clock::now() - warmupStart).count() / static_cast<double>(passes);
+        const auto iterations = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(s_sampleSeconds / secondsPerPass));
+
+        std::vector<double> ns(s_samples), cyc(s_samples);
+        for (int sample = 0; sample < s_samples; sample++)
+        {
+            const auto start = clock::now();
+            const auto startCycles = cycles();
+            for (std::uint64_t i = 0; i < iterations; i++) pass();
+            const auto endCycles = cycles();
+            const auto elapsed = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+
+            const auto ops = static_cast<double>(iterations * opsPerPass);
+            ns[sample] = elapsed / ops;
+            cyc[sample] = static_cast<double>(endCycles - startCycles) / ops;
+        }
+
+        double mean = 0.0, cyclesMean = 0.0;
+        for (int i = 0; i < s_samples; i++)
+        {
+            mean += ns[i];
+            cyclesMean += cyc[i];
+        }
+        mean /= s_samples;
+        cyclesMean /= s_samples;
+
+        double variance = 0.0;
+        for (const auto x: ns) variance += (x - mean) * (x - mean);
+        variance /= (s_samples - 1);
+
+        auto sorted = ns;
+        std::sort(sorted.begin(), sorted.end());
+        const double median = (sorted[s_samples / 2 - 1] + sorted[s_samples / 2]) / 2.0;
+
+        // Normal approximation, 30 samples is enough for the t correction to be negligible.
+        const double ci95 = 1.96 * std::sqrt(variance / s_samples);
+        return {name, iterations, opsPerPass, mean, median, ci95, cyclesMean};
+    }
+
+    struct Benchmark
+    {
+        const char *name;
+        std::function<std::uint64_t()> pass;
+    };
+
+    std::vector<chess::Board> corpusBoards()
+    {
+        std::vector<chess::Board> boards;
+        for (const auto &position: s_corpus) boards.emplace_back(std::string(position.fen));
+        return boards;
+    }
+
+    // Games from the starting position, each move drawn at random from the legal ones with a fixed seed, up to the
+    // end of the game or 300 plies.
+    std::vector<std::vector<chess::Move>> randomGames(int count)
+    {
+        std::mt19937 random(1);
+        std::vector<std::vector<chess::Move>> games(static_cast<std::size_t>(count));
+        for (auto &game: games)
+        {
+            chess::Board board;
+            for (auto result = chess::Result::LegalMove; result == chess::Result::LegalMove && game.size() < 300;)
+            {
+                chess::MoveList moves, legal;
+                board.generate(moves);
+                for (const auto move: moves)
+                    if (board.isLegal(move)) legal.push(move);
+                if (legal.empty()) break;
+
+                game.push_back(legal[static_cast<unsigned>(random() % legal.size())]);
+                result = board.move(game.back());
+            }
+        }
+        return games;
+    }
+
+    template<typename F>
+    void forEachSquare(F &&f)
+    {
+        for (int file = 0; file < 8; file++)
+            for (int rank = 0; rank < 8; rank++)
+                f(File(file), Rank(rank));
+    }
+
+    std::vector<Measurement> run(const std::string &filter)
+    {
+        using bench::BoardAccess;
+        const auto boards = corpusBoards();
+        const auto positions = boards.size();
+
+        std::vector<Benchmark> benchmarks;
+
+        benchmarks.push_back({"lineAttacks", [&] {
+            for (const auto &board: boards)
+                forEachSquare([&](File f, Rank r) { doNotOptimize(BoardAccess::lineAttacks(f, r, BoardAccess::all(board))); });
+            return positions * 64;
+        }});
+        benchmarks.push_back({"rookMoves", [&] {
+            for (const auto &board: boards)
+                forEachSquare([&](File f, Rank r) { doNotOptimize(BoardAccess::rookMoves(f, r, BoardAccess::all(board))); });
+            return positions * 64;
+        }});
+        benchmarks.push_back({"bishopMoves", [&] {
+            for (const auto &board: boards)
+                forEachSquare([&](File f, Rank r) { doNotOptimize(BoardAccess::bishopMoves(f, r, BoardAccess::all(board))); });
+            return positions * 64;
+        }});
+        benchmarks.push_back({"attackedBy<White>", [&] {
+            for (const auto &board: boards)
+                forEachSquare([&](File f, Rank r) { doNotOptimize(BoardAccess::attackedBy<chess::Color::White>(board, f, r)); });
+            return positions * 64;
+        }});
+        benchmarks.push_back({"attackedBy<Black>", [&] {
+            for (const auto &board: boards)
+                forEachSquare([&](File f, Rank r) { doNotOptimize(BoardAccess::attackedBy<chess::Color::Black>(board, f, r)); });
+            return positions * 64;
+        }});
+        benchmarks.push_back({"attackMap<White>", [&] {
+            for (const auto &board: boards)
+            {
+                const auto attacked = BoardAccess::attackMap<chess::Color::White>(board);
+                forEachSquare([&](File f, Rank r) { doNotOptimize(attacked & chess::Board::bitboard_t(1) << chess::squareIndex(f, r)); });
+            }
+            return positions * 64;
+        }});
+        benchmarks.push_back({"inCheck", [&] {
+            for (const auto &board: boards)
+                doNotOptimize(BoardAccess::turn(board) == chess::Color::White ? BoardAccess::inCheck<chess::Color::White>(board)
+                                                                              : BoardAccess::inCheck<chess::Color::Black>(board));
+            return positions;
+        }});
+        benchmarks.push_back({"piece", [&] {
+            for (const auto &board: boards)
+                forEachSquare([&](File f, Rank r) { doNotOptimize(BoardAccess::piece(board, f, r)); });
+            return positions * 64;
+        }});
+        benchmarks.push_back({"moves", [&] {
+            for (const auto &board: boards)
+                forEachSquare([&](File f, Rank r) { doNotOptimize(BoardAccess::moves(board, BoardAccess::piece(board, f, r), f, r)); });
+            return positions * 64;
+        }});
+
+        // Board::move mutates, so every operation first restores its position by copy. Board::copy times the copy alone
+        // so it can be subtracted.
+        std::vector<chess::Board> scratch(boards);
+        benchmarks.push_back({"Board::copy", [&] {
+            for (std::size_t i = 0; i < positions; i++)
+            {
+                scratch[i] = boards[i];
+                doNotOptimize(scratch[i]);
+            }
+            return positions;
+        }});
+        benchmarks.push_back({"Board::move", [&] {
+            for (std::size_t i = 0; i < positions; i++)
+            {
+                scratch[i] = boards[i];
+                doNotOptimize(scratch[i].move(s_corpus[i].move));
+            }
+            return positions;
+        }});
+        benchmarks.push_back({"Board::isLegal", [&] {
+            for (std::size_t i = 0; i < positions; i++)
+                doNotOptimize(boards[i].isLegal(chess::Move::parse(s_corpus[i].move)));
+            return positions;
+        }});
+        // One cache per position, so every pass after the first finds its square built, as repeated validation of
+        // moves in one position would.
+        std::vector<chess::LegalMoveCache> caches(positions);
+        benchmarks.push_back({"LegalMoveCache", [&] {
+            for (std::size_t i = 0; i < positions; i++)
+                doNotOptimize(caches[i].isLegal(boards[i], chess::Move::parse(s_corpus[i].move)));
+            return positions;
+        }});
+        benchmarks.push_back({"Board::set", [&] {
+            for (std::size_t i = 0; i < positions; i++)
+            {
+                scratch[i].set(s_corpus[i].fen);
+                doNotOptimize(scratch[i]);
+            }
+            return positions;
+        }});
+        // Each corpus position is started again as a new game in the place of the last one.
+        engine::GameStore store;
+        std::vector<std::uint64_t> games;
+        for (const auto &board: boards) games.push_back(store.create(board));
+        benchmarks.push_back({"GameStore::create", [&] {
+            for (std::size_t i = 0; i < positions; i++)
+            {
+                (void) store.erase(games[i]);
+                games[i] = store.create(boards[i]);
+            }
+            return positions;
+        }});
+        // Whole games of random legal moves, so most plies come deep into a run of reversible ones as they do in
+        // play, where the clock and so the repetition history are at their largest.
+        const auto scripts = randomGames(16);
+        std::uint64_t scriptPlies = 0;
+        for (const auto &script: scripts) scriptPlies += script.size();
+        benchmarks.push_back({"GameStore::play", [&] {
+            for (const auto &script: scripts)
+            {
+                const auto id = store.create(chess::Board());
+                for (const auto move: script) doNotOptimize(store.play(id, move));
+                (void) store.erase(id);
+            }
+            return scriptPlies;
+        }});
+        benchmarks.push_back({"Board::fen", [&] {
+            for (const auto &board: boards) doNotOptimize(board.fen());
+            return positions;
+        }});
+
+        std::vector<Measurement> results;
+        for (const auto &[name, pass]: benchmarks)
+        {
+            if (!filter.empty() && std::string(name).find(filter) == std::string::npos) continue;
+            results.push_back(measure(name, pass));
+
+            const auto &m = results.back();
+            std::cout << std::left << std::setw(20) << m.name << std::right << std::fixed << std::setprecision(2) << std::setw(10)
+                      << m.nsMean << " ns/op  +/- " << std::setw(6) << m.nsCi95 << "  (median " << m.nsMedian << ")  "
+                      << std::setw(10) << m.cyclesMean << " cycles/op\n";
+        }
+        return results;
+    }
+
+    void writeJson(const std::string &path, const std::vector<Measurement> &results)
+    {
+        std::ofstream out(path);
+        out << "{\n  \"engine\": \"" << NAME << "\",\n  \"version\": \"" << VERSION << "\",\n  \"compiler\": \"" << __VERSION__
+            << "\",\n  \"samples\": " << s_samples << ",\n  \"benchmarks\": [\n";
+        for (std::size_t i = 0; i < results.size(); i++)
+        {
+            const auto &m = results[i];
+            out << std::setprecision(4) << std::fixed << "    {\"name\": \"" << m.name << "\", \"ns_per_op\": " << m.nsMean
+                << ", \"ns_per_op_median\": " << m.nsMedian << ", \"ns_per_op_ci95\": " << m.nsCi95 << ", \"cycles_per_op\": "
+                << m.cyclesMean << ", \"ops_per_sample\": " << m.iterations * m.opsPerPass << "}" << (i + 1 < results.size() ? "," : "")
+                << "\n";
+        }
+        out << "  ]\n}\n";
+    }
+}
+
+// Usage: bench_micro [--filter <substring>] [--json <path>]
+int main(int argc, char **argv)
+{
+    std::string filter, json;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--filter") == 0) filter = argv[i + 1];
+        else if (std::strcmp(argv[i], "--json") == 0) json = argv[i + 1];
+    }
+
+    std::cout << HEADER_TEXT << '\n';
+    const auto results = run(filter);
+    if (!json.empty()) writeJson(json, results);
+}
@@ -1,42 +1,124 @@
 #ifndef CHESS_ENGINE_BOARD_HPP
 #define CHESS_ENGINE_BOARD_HPP
 
+#include <algorithm>
 #include <array>
+#include <span>
 #include <sstream>
+#include <vector>
 
 #include "Piece.h"
 #include "File.h"
 #include "Rank.h"
+#include "Move.h"
 #include "Result.h"
+#include "Zobrist.h"
+
+namespace bench
+{
+    struct BoardAccess;
+} // namespace bench
 
 namespace chess
 {
     class Board
     {
+        friend struct ::bench::BoardAccess; // Microbenchmarks time the private hot paths directly.
+
+    public:
         using bitboard_t = unsigned long long;
         static_assert(sizeof(bitboard_t) == 8, "bitboard_t must be 64 bits");
 
-        std::array<bitboard_t, 15> m_bitboards;
+        // Everything make() overwrites besides the pieces themselves, so unmake() can restore it.
+        struct Undo
+        {
+            zobrist_t key;
+            unsigned char enPassant;
+            unsigned char castling;
+            unsigned short halfMoveClock;
+            Piece moved;
+            Piece captured;
+        };
+
+        // The position proper without its history or caches: what a caller keeping a great many positions needs
+        // to hold to get a board back with a copy, where FEN or a packed form has to be decoded and hashed again.
+        struct State
+        {
+            std::array<bitboard_t, 6> pieces;
+            std::array<bitboard_t, 2> colors;
+            zobrist_t key;
+            zobrist_t pawnKey;
+            unsigned short halfMoveClock;
+            unsigned short fullMoveNumber;
+            unsigned char castling;
+            unsigned char enPassant;
+            Color turn;
+        };
+
+    private:
+        static constexpr const unsigned char s_noSquare = 64;
+
+        // The position proper: a cache line of bitboards, then everything else a move changes. The piece of a square
+        // is its type board ANDed with its colour board, and empty squares are what neither colour covers.
+        alignas(64) std::array<bitboard_t, 6> m_pieces; // By type, Piece & 7 minus one: pawn, knight, rook, bishop, queen, king.
+        std::array<bitboard_t, 2> m_colors;             // White, black.
+
+        zobrist_t m_key;
+        zobrist_t m_pawnKey; // Pawns alone, for caching pawn structure terms.
+        unsigned short m_halfMoveClock;
+        unsigned short m_fullMoveNumber;
+        unsigned char m_castling; // KQkq in bits 0 to 3.
+        unsigned char m_enPassant; // Square index, s_noSquare if none.
         Color m_turn;
-        bitboard_t m_enPassantSquare;
-        std::array<bool, 4> m_castling; // KQkq
+        mutable unsigned char m_attacksValid; // Bit 0 White, bit 1 Black.
 
-        [[nodiscard]] constexpr bitboard_t bitboard(Piece p) const noexcept { return m_bitboards[std::to_underlying(p)]; }
-        [[nodiscard]] constexpr bitboard_t bitboard(Color c) const noexcept { return m_bitboards[std::to_underlying(c)]; }
+        // Derived and cold, kept behind the position so they do not split it across cache lines.
+        // Attacked squares, indexed like Piece and Color: a piece slot holds everything that kind of piece attacks,
+        // a colour slot the union for the side. Filled per side on first use and dropped whenever a piece moves.
+        mutable std::array<bitboard_t, 15> m_attacks;
+        std::vector<zobrist_t> m_history; // Keys of all earlier positions, oldest first.
 
-        [[nodiscard]] constexpr bitboard_t &bitboard(Piece p) noexcept { return m_bitboards[std::to_underlying(p)]; }
-        [[nodiscard]] constexpr bitboard_t &bitboard(Color c) noexcept { return m_bitboards[std::to_underlying(c)]; }
+        [[nodiscard]] static constexpr int typeIndex(Piece p) noexcept { return (std::to_underlying(p) & 7) - 1; }
+
+        [[nodiscard]] static constexpr int colorIndex(Piece p) noexcept { return std::to_underlying(p) >> 3; }
+
+        [[nodiscard]] static constexpr int colorIndex(Color c) noexcept { return std::to_underlying(c) >> 3; }
+
+        [[nodiscard]] constexpr bitboard_t bitboard(Piece p) const noexcept
+        {
+            if (p == Piece::None) return ~all();
+            return m_pieces[typeIndex(p)] & m_colors[colorIndex(p)];
+        }
 
-        [[nodiscard]] constexpr bitboard_t all() const noexcept { return ~bitboard(Piece::None); }
+        [[nodiscard]] constexpr bitboard_t bitboard(Color c) const noexcept { return m_colors[colorIndex(c)]; }
+
+        // Adds or removes a piece on the given squares.
+        constexpr void flip(Piece p, bitboard_t squares) noexcept
+        {
+            m_pieces[typeIndex(p)] ^= squares;
+            m_colors[colorIndex(p)] ^= squares;
+        }
+
+        [[nodiscard]] constexpr bitboard_t all() const noexcept { return m_colors[0] | m_colors[1]; }
         [[nodiscard]] constexpr Piece piece(bitboard_t square) const noexcept
         {
-            for (const auto &p: s_piecesList)
-                if (bitboard(p) & square)
-                    return p;
+            if ((all() & square) == s_emptyBoard) return Piece::None;
+
+            const auto color = (m_colors[1] & square) ? 8 : 0;
+            for (int type = 0; type < 6; type++)
+                if (m_pieces[type] & square)
+                    return Piece((type + 1) | color);
 
             return Piece::None;
         }
 
+        [[nodiscard]] constexpr bitboard_t enPassantBoard() const noexcept
+        {
+            return m_enPassant == s_noSquare ? s_emptyBoard : bitboard_t(1) << m_enPassant;
+        }
+
+        [[nodiscard]] constexpr bool hasCastling(int right) const noexcept { return (m_castling >> right) & 1; }
+
         template<Piece P>
         [[nodiscard]] constexpr std::pair<File, Rank> find() const noexcept
         {
@@ -66,24 +148,246 @@ namespace chess
                    (kingMoves<opponentColor>(f, r) & bitboard(king));
         }
 
+        // Pieces of color C attacking the given square, with sliders blocked by occupancy instead of the current board.
         template<Color C>
-        [[nodiscard]] constexpr bool inCheck() const noexcept
+        [[nodiscard]] constexpr bitboard_t attackers(bitboard_t target, bitboard_t occupancy) const noexcept
         {
-            // TODO: Validate post-move that the king is not in check.
-            const auto king = Colored::King<C>;
-            const auto [f, r] = find<king>();
+            const auto idx = index(target);
+            const auto f = 7 - (idx & 7);
+            const auto r = idx >> 3;
+
+            const auto pawnSources = C == Color::White ? s_bPawnAttacks[f][r] : s_wPawnAttacks[f][r];
+            const auto queens = bitboard(Colored::Queen<C>);
+            return (pawnSources & bitboard(Colored::Pawn<C>)) | (s_knightMoves[f][r] & bitboard(Colored::Knight<C>)) |
+                   (rookMoves(File(f), Rank(r), occupancy) & (bitboard(Colored::Rook<C>) | queens)) |
+                   (bishopMoves(File(f), Rank(r), occupancy) & (bitboard(Colored::Bishop<C>) | queens)) |
+                   (s_kingMoves[f][r] & bitboard(Colored::King<C>));
+        }
+
+        template<Color C>
+        constexpr void computeAttacks() const noexcept
+        {
+            const auto occupied = all();
+            const auto &pawnAttacks = C == Color::White ? s_wPawnAttacks : s_bPawnAttacks;
+            auto pieceAttacks = [&](Piece p, auto targets) noexcept
+            {
+                bitboard_t attacked = s_emptyBoard;
+                for (auto pieces = bitboard(p); pieces; pieces &= pieces - 1)
+                {
+                    const auto from = index(pieces & -pieces);
+                    attacked |= targets(squareFile(from), squareRank(from));
+                }
+                m_attacks[std::to_underlying(p)] = attacked;
+                return attacked;
+            };
+
+            m_attacks[std::to_underlying(C)] =
+                    pieceAttacks(Colored::Pawn<C>, [&](File f, Rank r) { return pawnAttacks[std::to_underlying(f)][std::to_underlying(r)]; }) |
+                    pieceAttacks(Colored::Knight<C>, [](File f, Rank r) { return s_knightMoves[std::to_underlying(f)][std::to_underlying(r)]; }) |
+                    pieceAttacks(Colored::Bishop<C>, [&](File f, Rank r) { return bishopMoves(f, r, occupied); }) |
+                    pieceAttacks(Colored::Rook<C>, [&](File f, Rank r) { return rookMoves(f, r, occupied); }) |
+                    pieceAttacks(Colored::Queen<C>, [&](File f, Rank r) { return queenMoves(f, r, occupied); }) |
+                    pieceAttacks(Colored::King<C>, [](File f, Rank r) { return s_kingMoves[std::to_underlying(f)][std::to_underlying(r)]; });
+            m_attacksValid |= C == Color::White ? 1 : 2;
+        }
 
+        // Plays a non-king move on a scratch occupancy and checks that no enemy piece, other than the captured one, then
+        // sees the king.
+        template<Color C>
+        [[nodiscard]] constexpr bool kingSafeAfter(bitboard_t fromSquare, bitboard_t toSquare, bitboard_t captured) const noexcept
+        {
             const auto opponentColor = Colored::Opposite<C>;
-            return attackedBy<opponentColor>(f, r) != s_emptyBoard;
+            const auto occupancy = (all() ^ fromSquare ^ captured) | toSquare;
+            return (attackers<opponentColor>(bitboard(Colored::King<C>), occupancy) & ~captured) == s_emptyBoard;
+        }
+
+        // Where the king can castle to, for a king that is not in check.
+        template<Color C>
+        [[nodiscard]] constexpr bitboard_t castlingDestinations() const noexcept
+        {
+            const auto opponentColor = Colored::Opposite<C>;
+            const auto rank = C == Color::White ? Rank::One : Rank::Eight;
+            const auto kingSide = C == Color::White ? 0 : 2;
+            if (bitboard(Colored::King<C>) != square(File::E, rank)) return s_emptyBoard;
+
+            const auto occupied = all();
+            const auto rook = bitboard(Colored::Rook<C>);
+            bitboard_t destinations = s_emptyBoard;
+            const auto kingSidePath = square(File::F, rank) | square(File::G, rank);
+            if (hasCastling(kingSide) && (rook & square(File::H, rank)) && (occupied & kingSidePath) == s_emptyBoard &&
+                !attackers<opponentColor>(square(File::F, rank), occupied) && !attackers<opponentColor>(square(File::G, rank), occupied))
+                destinations |= square(File::G, rank);
+
+            const auto queenSidePath = square(File::B, rank) | square(File::C, rank) | square(File::D, rank);
+            if (hasCastling(kingSide + 1) && (rook & square(File::A, rank)) && (occupied & queenSidePath) == s_emptyBoard &&
+                !attackers<opponentColor>(square(File::D, rank), occupied) && !attackers<opponentColor>(square(File::C, rank), occupied))
+                destinations |= square(File::C, rank);
+            return destinations;
+        }
+
+        // Legal destinations of the piece on fromSquare, which must be C's: its moves that do not leave the king
+        // attacked, found on scratch occupancies instead of by playing them.
+        template<Color C>
+        [[nodiscard]] constexpr bitboard_t computeLegal(bitboard_t fromSquare) const noexcept
+        {
+            const auto opponentColor = Colored::Opposite<C>;
+            const auto fromPiece = piece(fromSquare);
+            const auto from = index(fromSquare);
+            const auto targets = moves(fromPiece, squareFile(from), squareRank(from));
+
+            bitboard_t legal = s_emptyBoard;
+            if (fromPiece == Colored::King<C>)
+            {
+                for (auto remaining = targets; remaining; remaining &= remaining - 1)
+                    if (attackers<opponentColor>(remaining & -remaining, all() ^ fromSquare) == s_emptyBoard) legal |= remaining & -remaining;
+                return inCheck<C>() ? legal : legal | castlingDestinations<C>();
+            }
+
+            // Off every line through the king a piece cannot be pinned, so out of check all its moves but en passant stand.
+            const auto kingIndex = index(bitboard(Colored::King<C>));
+            auto unsure = targets;
+            if ((fromSquare & queenMoves(squareFile(kingIndex), squareRank(kingIndex), s_emptyBoard)) == s_emptyBoard && !inCheck<C>())
+            {
+                unsure = fromPiece == Colored::Pawn<C> ? targets & enPassantBoard() : s_emptyBoard;
+                legal = targets & ~unsure;
+            }
+
+            for (auto remaining = unsure; remaining; remaining &= remaining - 1)
+            {
+                const auto toSquare = remaining & -remaining;
+                auto captured = toSquare & bitboard(opponentColor);
+                if (fromPiece == Colored::Pawn<C> && toSquare == enPassantBoard()) captured = C == Color::White ? toSquare >> 8 : toSquare << 8;
+                if (kingSafeAfter<C>(fromSquare, toSquare, captured)) legal |= toSquare;
+            }
+            return legal;
+        }
+
+        template<Piece P, Color C>
+        [[nodiscard]] constexpr bool pieceHasLegalMove(bitboard_t checkers, bitboard_t kingLines) const noexcept
+        {
+            const auto enemy = bitboard(Colored::Opposite<C>);
+            for (auto pieces = bitboard(P); pieces; pieces &= pieces - 1)
+            {
+                const auto fromSquare = pieces & -pieces;
+                const auto idx = index(fromSquare);
+                const auto targets = moves<P>(File(7 - (idx & 7)), Rank(idx >> 3));
+                if (targets == s_emptyBoard) continue;
+
+                // Off every line through the king a piece cannot be pinned, so out of check any of its moves is legal.
+                // En passant is left to the full test since it also lifts the captured pawn off the board.
+                const bool unpinned = checkers == s_emptyBoard && (fromSquare & kingLines) == s_emptyBoard;
+                if (unpinned && (targets & ~enPassantBoard()) != s_emptyBoard) return true;
+
+                for (auto remaining = targets; remaining; remaining &= remaining - 1)
+                {
+                    const auto toSquare = remaining & -remaining;
+                    auto captured = toSquare & enemy;
+                    if (P == Colored::Pawn<C> && toSquare == enPassantBoard())
+                        captured = C == Color::White ? toSquare >> 8 : toSquare << 8;
+
+                    if (kingSafeAfter<C>(fromSquare, toSquare, captured)) return true;
+                }
+            }
+            return false;
+        }
+
+        // Squares strictly between two squares on a common line, none if they share no line.
+        [[nodiscard]] static constexpr bitboard_t between(int a, int b) noexcept
+        {
+            const auto fa = squareFile(a), fb = squareFile(b);
+            const auto ra = squareRank(a), rb = squareRank(b);
+            const auto occupancy = square(a) | square(b);
+            if (fa == fb || ra == rb) return rookMoves(fa, ra, occupancy) & rookMoves(fb, rb, occupancy);
+
+            const auto files = std::to_underlying(fa) - std::to_underlying(fb);
+            const auto ranks = std::to_underlying(ra) - std::to_underlying(rb);
+            if (files == ranks || files == -ranks) return bishopMoves(fa, ra, occupancy) & bishopMoves(fb, rb, occupancy);
+            return s_emptyBoard;
+        }
+
+        // Pawn moves of the given pawns onto targets, promotions counted once per piece. En passant is left out.
+        template<Color C>
+        [[nodiscard]] constexpr unsigned countPawnMoves(bitboard_t pawns, bitboard_t targets) const noexcept
+        {
+            constexpr auto Them = Colored::Opposite<C>;
+            constexpr bitboard_t fileA = 0x8080808080808080, fileH = 0x0101010101010101;
+            constexpr bitboard_t lastRank = C == Color::White ? 0xFF00000000000000 : 0x00000000000000FF;
+            constexpr bitboard_t thirdRank = C == Color::White ? 0x0000000000FF0000 : 0x0000FF0000000000;
+            auto forward = [](bitboard_t b) { return C == Color::White ? b << 8 : b >> 8; };
+
+            const auto empty = ~all();
+            const auto single = forward(pawns) & empty;
+            const auto pushes = std::array{single, forward(single & thirdRank) & empty, forward((pawns & ~fileA) << 1) & bitboard(Them),
+                                           forward((pawns & ~fileH) >> 1) & bitboard(Them)};
+
+            unsigned count = 0;
+            for (std::size_t i = 0; i < pushes.size(); i++)
+            {
+                const auto moves = pushes[i] & targets;
+                count += static_cast<unsigned>(__builtin_popcountll(moves & ~lastRank) + 4 * __builtin_popcountll(moves & lastRank));
+            }
+            return count;
+        }
+
+        // Stops at the first legal move found. The king goes first as it needs no pin analysis, then the remaining pieces
+        // from the cheapest to generate. Castling never needs checking: if it is legal, so is the king's step towards it.
+        template<Color C>
+        [[nodiscard]] constexpr bool hasLegalMove() const noexcept
+        {
+            const auto opponentColor = Colored::Opposite<C>;
+            const auto kingSquare = bitboard(Colored::King<C>);
+            const auto idx = index(kingSquare);
+            const auto kingFile = File(7 - (idx & 7));
+            const auto kingRank = Rank(idx >> 3);
+
+            const auto withoutKing = all() ^ kingSquare;
+            for (auto targets = kingMoves<C>(kingFile, kingRank); targets; targets &= targets - 1)
+                if (attackers<opponentColor>(targets & -targets, withoutKing) == s_emptyBoard)
+                    return true;
+
+            const auto checkers = attackers<opponentColor>(kingSquare, all());
+            if (checkers & (checkers - 1)) return false; // Double check, only the king could have moved.
+
+            const auto kingLines = queenMoves(kingFile, kingRank, s_emptyBoard);
+            return pieceHasLegalMove<Colored::Pawn<C>, C>(checkers, kingLines) ||
+                   pieceHasLegalMove<Colored::Knight<C>, C>(checkers, kingLines) ||
+                   pieceHasLegalMove<Colored::Bishop<C>, C>(checkers, kingLines) ||
+                   pieceHasLegalMove<Colored::Rook<C>, C>(checkers, kingLines) ||
+                   pieceHasLegalMove<Colored::Queen<C>, C>(checkers, kingLines);
+        }
+
+        // Dead positions by material alone: bare kings, a single minor piece, or only bishops that all share a square color.
+        [[nodiscard]] constexpr bool insufficientMaterial() const noexcept
+        {
+            const auto heavy = bitboard(Piece::WPawn) | bitboard(Piece::BPawn) | bitboard(Piece::WRook) | bitboard(Piece::BRook) |
+                               bitboard(Piece::WQueen) | bitboard(Piece::BQueen);
+            if (heavy != s_emptyBoard) return false;
+
+            const auto knights = bitboard(Piece::WKnight) | bitboard(Piece::BKnight);
+            const auto bishops = bitboard(Piece::WBishop) | bitboard(Piece::BBishop);
+            const auto minors = knights | bishops;
+            if ((minors & (minors - 1)) == s_emptyBoard) return true;
+
+            return knights == s_emptyBoard && ((bishops & s_darkSquares) == s_emptyBoard || (bishops & ~s_darkSquares) == s_emptyBoard);
+        }
+
+        template<Color C>
+        [[nodiscard]] constexpr Status status() const noexcept
+        {
+            if (!hasLegalMove<C>()) return inCheck<C>() ? Status::Checkmate : Status::Stalemate;
+            if (insufficientMaterial()) return Status::InsufficientMaterial;
+            if (isFiftyMoveDraw()) return Status::FiftyMoveRule;
+            if (isThreefoldRepetition()) return Status::Repetition;
+            return Status::Ongoing;
         }
 
         template<Color C>
         [[nodiscard]] constexpr bitboard_t pawnAttacks(File f, Rank r) const noexcept
         {
             if constexpr (C == Color::White)
-                return (s_wPawnAttacks[std::to_underlying(f)][std::to_underlying(r)] & (bitboard(Color::Black) | m_enPassantSquare));
+                return (s_wPawnAttacks[std::to_underlying(f)][std::to_underlying(r)] & (bitboard(Color::Black) | enPassantBoard()));
             else if constexpr (C == Color::Black)
-                return (s_bPawnAttacks[std::to_underlying(f)][std::to_underlying(r)] & (bitboard(Color::White) | m_enPassantSquare));
+                return (s_bPawnAttacks[std::to_underlying(f)][std::to_underlying(r)] & (bitboard(Color::White) | enPassantBoard()));
         }
 
         template<Color C>
@@ -191,188 +495,316 @@ namespace chess
         template<Color C>
         constexpr void move(bitboard_t fromSquare, Piece fromPiece, bitboard_t toSquare, Piece toPiece) noexcept
         {
-            bitboard(fromPiece) ^= (fromSquare | toSquare);
-            bitboard(C) ^= (fromSquare | toSquare);
-            bitboard(Piece::None) ^= fromSquare;
-
-            bitboard(toPiece) ^= toSquare;
+            m_attacksValid = 0;
+            flip(fromPiece, fromSquare | toSquare);
             if (toPiece != Piece::None)
             {
                 const auto oppositeColor = Colored::Opposite<C>;
-                bitboard(oppositeColor) ^= toSquare;
+                flip(toPiece, toSquare);
+                m_key ^= Zobrist::piece(toPiece, index(toSquare));
+                if (toPiece == Colored::Pawn<oppositeColor>) m_pawnKey ^= Zobrist::piece(toPiece, index(toSquare));
             }
+
+            const auto movedKey = Zobrist::piece(fromPiece, index(fromSquare)) ^ Zobrist::piece(fromPiece, index(toSquare));
+            m_key ^= movedKey;
+            if (fromPiece == Colored::Pawn<C>) m_pawnKey ^= movedKey;
         }
 
         template<Color C>
         constexpr void promote(bitboard_t fromSquare, Piece fromPiece, bitboard_t toSquare, Piece toPiece, Piece newPiece) noexcept
         {
             move<C>(fromSquare, fromPiece, toSquare, toPiece);
-            bitboard(fromPiece) ^= toSquare;
-            bitboard(newPiece) ^= toSquare;
+            m_pieces[typeIndex(fromPiece)] ^= toSquare;
+            m_pieces[typeIndex(newPiece)] ^= toSquare;
+            m_key ^= Zobrist::piece(fromPiece, index(toSquare)) ^ Zobrist::piece(newPiece, index(toSquare));
+            if (fromPiece == Colored::Pawn<C>) m_pawnKey ^= Zobrist::piece(fromPiece, index(toSquare));
+        }
+
+        constexpr void clearCastling(int right) noexcept
+        {
+            if (hasCastling(right))
+            {
+                m_castling &= static_cast<unsigned char>(~(1 << right));
+                m_key ^= Zobrist::castling(right);
+            }
+        }
+
+        // The en passant file only enters the key when a pawn could actually capture there, so positions that differ
+        // only by an unusable en passant square still count as repetitions.
+        [[nodiscard]] constexpr zobrist_t enPassantKey() const noexcept
+        {
+            if (m_enPassant == s_noSquare) return 0;
+
+            const auto idx = m_enPassant;
+            const auto f = 7 - (idx & 7);
+            const auto r = idx >> 3;
+            const auto capturers = Rank(r) == Rank::Three ? s_wPawnAttacks[f][r] & bitboard(Piece::BPawn)
+                                                          : s_bPawnAttacks[f][r] & bitboard(Piece::WPawn);
+            return capturers != s_emptyBoard ? Zobrist::enPassant(f) : 0;
+        }
+
+        // Must run before the pieces of the current move are shifted, so the old key term is recomputed unchanged.
+        constexpr void setEnPassant(bitboard_t enPassantSquare) noexcept
+        {
+            m_key ^= enPassantKey();
+            m_enPassant = enPassantSquare == s_emptyBoard ? s_noSquare : static_cast<unsigned char>(index(enPassantSquare));
+            m_key ^= enPassantKey();
+        }
+
+        [[nodiscard]] constexpr zobrist_t computeKey() const noexcept
+        {
+            zobrist_t key = 0;
+            for (const auto &p: s_piecesList)
+                for (auto b = bitboard(p); b; b &= b - 1)
+                    key ^= Zobrist::piece(p, __builtin_ctzll(b));
+
+            for (int right = 0; right < 4; right++)
+                if (hasCastling(right)) key ^= Zobrist::castling(right);
+
+            if (m_turn == Color::Black) key ^= Zobrist::Side;
+            return key ^ enPassantKey();
+        }
+
+        [[nodiscard]] constexpr zobrist_t computePawnKey() const noexcept
+        {
+            zobrist_t key = 0;
+            for (const auto p: {Piece::WPawn, Piece::BPawn})
+                for (auto b = bitboard(p); b; b &= b - 1)
+                    key ^= Zobrist::piece(p, __builtin_ctzll(b));
+            return key;
+        }
+
+        [[nodiscard]] static constexpr int index(bitboard_t square) noexcept { return __builtin_ctzll(square); }
+
+        constexpr void togglePiece(Piece p, bitboard_t sqr) noexcept
+        {
+            m_attacksValid = 0;
+            flip(p, sqr);
+            m_key ^= Zobrist::piece(p, index(sqr));
+            if (p == Piece::WPawn || p == Piece::BPawn) m_pawnKey ^= Zobrist::piece(p, index(sqr));
+        }
+
+        // A move from or to a king or rook home square ends the castling rights tied to it.
+        constexpr void updateCastling(int sqr) noexcept
+        {
+            switch (sqr)
+            {
+                case 0: // h1
+                    clearCastling(0);
+                    break;
+                case 3: // e1
+                    clearCastling(0);
+                    clearCastling(1);
+                    break;
+                case 7: // a1
+                    clearCastling(1);
+                    break;
+                case 56: // h8
+                    clearCastling(2);
+                    break;
+                case 59: // e8
+                    clearCastling(2);
+                    clearCastling(3);
+                    break;
+                case 63: // a8
+                    clearCastling(3);
+                    break;
+                default:
+                    break;
+            }
         }
 
         template<Color C>
-        [[nodiscard]] constexpr std::pair<bool, bitboard_t> validateCastlingDestination(bitboard_t toSquare) noexcept
+        [[nodiscard]] static constexpr Piece promotionPiece(Promotion promotion) noexcept
         {
-            // Yes castling is ugly. It's the last thing left here and I just want to get it working.
-            // TODO: Clean.
-            if constexpr (C == Color::White)
+            switch (promotion)
             {
-                if (toSquare == square(File::C, Rank::One))
-                {
-                    const auto shouldBeEmpty = square(File::B, Rank::One) | square(File::C, Rank::One) | square(File::D, Rank::One);
-                    if ((bitboard(Piece::None) & shouldBeEmpty) == shouldBeEmpty)
-                    {
-                        const bool passedChecks =
-                                attackedBy<Color::Black>(File::C, Rank::One) || attackedBy<Color::Black>(File::D, Rank::One) ||
-                                attackedBy<Color::Black>(File::E, Rank::One);
-                        if (!passedChecks)
-                        {
-                            const bool result = m_castling[1];
-                            m_castling[1] = false;
-                            return {result, square(File::D, Rank::One)};
-                        }
-                    }
-                }
-                else if (toSquare == square(File::G, Rank::One))
-                {
-                    const auto shouldBeEmpty = square(File::F, Rank::One) | square(File::G, Rank::One);
-                    if ((bitboard(Piece::None) & shouldBeEmpty) == shouldBeEmpty)
-                    {
-                        const bool passedChecks =
-                                attackedBy<Color::Black>(File::E, Rank::One) || attackedBy<Color::Black>(File::F, Rank::One) ||
-                                attackedBy<Color::Black>(File::G, Rank::One);
-                        if (!passedChecks)
-                        {
-                            const bool result = m_castling[0];
-                            m_castling[0] = false;
-                            return {result, square(File::F, Rank::One)};
-                        }
-                    }
-                }
+                case Promotion::Knight:
+                    return Colored::Knight<C>;
+                case Promotion::Bishop:
+                    return Colored::Bishop<C>;
+                case Promotion::Rook:
+                    return Colored::Rook<C>;
+                case Promotion::Queen:
+                case Promotion::None:
+                default:
+                    return Colored::Queen<C>;
             }
-            else if constexpr (C == Color::Black)
+        }
+
+        template<Color C>
+        static constexpr void pushMoves(MoveList &list, int from, bitboard_t targets) noexcept
+        {
+            for (; targets; targets &= targets - 1)
+                list.push(Move(from, index(targets & -targets)));
+        }
+
+        // Pseudo-legal moves: everything but the check that the mover's king is safe afterwards, which make() does.
+        // CapturesOnly keeps captures and queen promotions, for quiescence search.
+        template<Color C, bool CapturesOnly>
+        constexpr void generateMoves(MoveList &list) const noexcept
+        {
+            const auto opponentColor = Colored::Opposite<C>;
+            const auto mask = CapturesOnly ? bitboard(opponentColor) : ~bitboard(C);
+            const auto lastRank = C == Color::White ? 0xFF00000000000000 : 0x00000000000000FF;
+
+            for (auto pawns = bitboard(Colored::Pawn<C>); pawns; pawns &= pawns - 1)
             {
-                if (toSquare == square(File::C, Rank::Eight))
-                {
-                    const auto shouldBeEmpty = square(File::B, Rank::Eight) | square(File::C, Rank::Eight) | square(File::D, Rank::Eight);
-                    if ((bitboard(Piece::None) & shouldBeEmpty) == shouldBeEmpty)
-                    {
-                        const bool passedChecks =
-                                attackedBy<Color::White>(File::C, Rank::Eight) || attackedBy<Color::White>(File::D, Rank::Eight) ||
-                                attackedBy<Color::White>(File::E, Rank::Eight);
-                        if (!passedChecks)
-                        {
-                            const bool result = m_castling[3];
-                            m_castling[3] = false;
-                            return {result, square(File::D, Rank::Eight)};
-                        }
-                    }
-                }
-                else if (toSquare == square(File::G, Rank::Eight))
+                const auto from = index(pawns & -pawns);
+                auto targets = pawnMoves<C>(squareFile(from), squareRank(from));
+                if constexpr (CapturesOnly) targets &= bitboard(opponentColor) | enPassantBoard() | lastRank;
+
+                for (; targets; targets &= targets - 1)
                 {
-                    const auto shouldBeEmpty = square(File::F, Rank::Eight) | square(File::G, Rank::Eight);
-                    if ((bitboard(Piece::None) & shouldBeEmpty) == shouldBeEmpty)
+                    const auto toSquare = targets & -targets;
+                    const auto to = index(toSquare);
+                    if (toSquare & lastRank)
                     {
-                        const bool passedChecks =
-                                attackedBy<Color::White>(File::E, Rank::Eight) || attackedBy<Color::White>(File::F, Rank::Eight) ||
-                                attackedBy<Color::White>(File::G, Rank::Eight);
-                        if (!passedChecks)
+                        list.push(Move(from, to, Promotion::Queen));
+                        if constexpr (!CapturesOnly)
                         {
-                            const bool result = m_castling[2];
-                            m_castling[2] = false;
-                            return {result, square(File::F, Rank::Eight)};
+                            list.push(Move(from, to, Promotion::Knight));
+                            list.push(Move(from, to, Promotion::Rook));
+                            list.push(Move(from, to, Promotion::Bishop));
                         }
                     }
+                    else list.push(Move(from, to));
                 }
             }
-            return {false, s_emptyBoard};
-        }
 
-        template<Color C>
-        [[nodiscard]] static consteval bitboard_t castlingSquares() noexcept
-        {
-            const auto rank = (C == Color::White) ? Rank::One : Rank::Eight;
-            return square(File::C, rank) | square(File::G, rank);
+            const auto occupied = all();
+            for (auto knights = bitboard(Colored::Knight<C>); knights; knights &= knights - 1)
+            {
+                const auto from = index(knights & -knights);
+                pushMoves<C>(list, from, s_knightMoves[std::to_underlying(squareFile(from))][std::to_underlying(squareRank(from))] & mask);
+            }
+            for (auto bishops = bitboard(Colored::Bishop<C>); bishops; bishops &= bishops - 1)
+            {
+                const auto from = index(bishops & -bishops);
+                pushMoves<C>(list, from, bishopMoves(squareFile(from), squareRank(from), occupied) & mask);
+            }
+            for (auto rooks = bitboard(Colored::Rook<C>); rooks; rooks &= rooks - 1)
+            {
+                const auto from = index(rooks & -rooks);
+                pushMoves<C>(list, from, rookMoves(squareFile(from), squareRank(from), occupied) & mask);
+            }
+            for (auto queens = bitboard(Colored::Queen<C>); queens; queens &= queens - 1)
+            {
+                const auto from = index(queens & -queens);
+                pushMoves<C>(list, from, queenMoves(squareFile(from), squareRank(from), occupied) & mask);
+            }
+
+            const auto king = bitboard(Colored::King<C>);
+            const auto kingFrom = index(king);
+            pushMoves<C>(list, kingFrom, s_kingMoves[std::to_underlying(squareFile(kingFrom))][std::to_underlying(squareRank(kingFrom))] & mask);
+
+            if constexpr (!CapturesOnly)
+            {
+                // The king may not start on or pass through an attacked square; the destination is make()'s business.
+                const auto rank = C == Color::White ? Rank::One : Rank::Eight;
+                const auto kingSide = C == Color::White ? 0 : 2;
+                if (king != square(File::E, rank) || (!hasCastling(kingSide) && !hasCastling(kingSide + 1))) return;
+                if (isAttacked<opponentColor>(king)) return;
+
+                const auto empty = bitboard(Piece::None);
+                const auto rook = bitboard(Colored::Rook<C>);
+                const auto kingSidePath = square(File::F, rank) | square(File::G, rank);
+                if (hasCastling(kingSide) && (rook & square(File::H, rank)) && (empty & kingSidePath) == kingSidePath &&
+                    !isAttacked<opponentColor>(square(File::F, rank)))
+                    list.push(Move(kingFrom, index(square(File::G, rank))));
+
+                const auto queenSidePath = square(File::B, rank) | square(File::C, rank) | square(File::D, rank);
+                if (hasCastling(kingSide + 1) && (rook & square(File::A, rank)) && (empty & queenSidePath) == queenSidePath &&
+                    !isAttacked<opponentColor>(square(File::D, rank)))
+                    list.push(Move(kingFrom, index(square(File::C, rank))));
+            }
         }
 
         template<Color C>
-        constexpr bool moveHelper(File fromFile, Rank fromRank, File toFile, Rank toRank, const std::string_view &uciMove)
+        constexpr void apply(Move move, Undo &undo) noexcept
         {
-            const auto fromSquare = square(fromFile, fromRank);
+            const auto opponentColor = Colored::Opposite<C>;
+            const auto fromSquare = square(move.from());
+            const auto toSquare = square(move.to());
             const auto fromPiece = piece(fromSquare);
-            const auto toSquare = square(toFile, toRank);
+            const auto toPiece = piece(toSquare);
 
-            const auto king = Colored::King<C>;
-            const bool kingMove = fromPiece == king;
-            const bool isCastle =
-                    kingMove && fromSquare == s_startingPosition[std::to_underlying(king)] && (toSquare | castlingSquares<C>());
-            if (isCastle)
-            {
-                const auto [canCastle, rookSquare] = validateCastlingDestination<C>(toSquare);
-                if (!canCastle) { return false; }
+            undo = {m_key, m_enPassant, m_castling, m_halfMoveClock, fromPiece, toPiece};
+            m_history.push_back(m_key);
 
-                const auto rook = Colored::Rook<C>;
-                move<C>(fromSquare, fromPiece, toSquare, Piece::None);
-                move<C>(s_startingPosition[std::to_underlying(rook)], rook, rookSquare, Piece::None);
-                return true;
-            }
+            const auto enPassantSquare = enPassantBoard();
+            setEnPassant(s_emptyBoard);
 
-            if (kingMove)
+            const bool pawnMove = fromPiece == Colored::Pawn<C>;
+            const auto distance = move.to() - move.from();
+            if (fromPiece == Colored::King<C> && (distance == 2 || distance == -2))
             {
-                if constexpr (C == Color::White)
-                {
-                    m_castling[0] = false;
-                    m_castling[1] = false;
-                }
-                else if constexpr (C == Color::Black)
-                {
-                    m_castling[2] = false;
-                    m_castling[3] = false;
-                }
+                // Squares count from h1, so the king side rook is three squares below the king and the queen side four above.
+                const auto kingSide = distance < 0;
+                const auto rookFrom = kingSide ? move.from() - 3 : move.from() + 4;
+                const auto rookTo = kingSide ? move.from() - 1 : move.from() + 1;
+                this->move<C>(fromSquare, fromPiece, toSquare, Piece::None);
+                this->move<C>(square(rookFrom), Colored::Rook<C>, square(rookTo), Piece::None);
             }
-            else if (fromPiece == Colored::Rook<C>)
+            else if (move.promotion() != Promotion::None)
             {
-                if constexpr (C == Color::White)
-                {
-                    if (fromSquare == square(File::H, Rank::One)) { m_castling[0] = false; }
-                    else if (fromSquare == square(File::A, Rank::One)) { m_castling[1] = false; }
-                }
-                else if constexpr (C == Color::Black)
+                promote<C>(fromSquare, fromPiece, toSquare, toPiece, promotionPiece<C>(move.promotion()));
+            }
+            else
+            {
+                this->move<C>(fromSquare, fromPiece, toSquare, toPiece);
+                if (pawnMove)
                 {
-                    if (fromSquare == square(File::H, Rank::Eight)) { m_castling[2] = false; }
-                    else if (fromSquare == square(File::A, Rank::Eight)) { m_castling[3] = false; }
+                    const auto behind = C == Color::White ? toSquare >> 8 : toSquare << 8;
+                    if (toSquare == enPassantSquare) togglePiece(Colored::Pawn<opponentColor>, behind);
+                    else if (distance == 16 || distance == -16) setEnPassant(behind);
                 }
             }
 
-            const auto legalMoves = moves(fromPiece, fromFile, fromRank);
-            if ((legalMoves & toSquare) == s_emptyBoard) { return false; }
+            updateCastling(move.from());
+            updateCastling(move.to());
 
-            const auto toPiece = piece(toSquare);
-            const bool promotion = fromPiece == Colored::Pawn<C> && toRank == Rank::Eight;
-            if (!promotion)
-            {
-                move<C>(fromSquare, fromPiece, toSquare, toPiece);
+            m_halfMoveClock = (pawnMove || toPiece != Piece::None) ? 0 : m_halfMoveClock + 1;
+            if constexpr (C == Color::Black) m_fullMoveNumber++;
+            m_turn = opponentColor;
+            m_key ^= Zobrist::Side;
+        }
 
-                const bool doublePush = (fromPiece == Piece::WPawn && fromRank == Rank::Two && toRank == Rank::Four) ||
-                                        (fromPiece == Piece::BPawn && fromRank == Rank::Seven && toRank == Rank::Five);
+        template<Color C>
+        constexpr void revert(Move move, const Undo &undo) noexcept
+        {
+            const auto opponentColor = Colored::Opposite<C>;
+            const auto fromSquare = square(move.from());
+            const auto toSquare = square(move.to());
 
-                m_enPassantSquare = doublePush ? toSquare >> 8 : s_emptyBoard;
-                return true;
+            // Piece updates are XORs, so replaying the same updates takes them back.
+            const auto distance = move.to() - move.from();
+            if (undo.moved == Colored::King<C> && (distance == 2 || distance == -2))
+            {
+                const auto kingSide = distance < 0;
+                const auto rookFrom = kingSide ? move.from() - 3 : move.from() + 4;
+                const auto rookTo = kingSide ? move.from() - 1 : move.from() + 1;
+                this->move<C>(fromSquare, undo.moved, toSquare, Piece::None);
+                this->move<C>(square(rookFrom), Colored::Rook<C>, square(rookTo), Piece::None);
+            }
+            else if (move.promotion() != Promotion::None)
+            {
+                promote<C>(fromSquare, undo.moved, toSquare, undo.captured, promotionPiece<C>(move.promotion()));
             }
             else
             {
-                // If piece is unspecified, assume queen
-                const auto newPiece = (uciMove.size() == 4) ? Colored::Queen<C> : charPiece<C>(uciMove[4]);
-                const bool validPromotion =
-                        newPiece == Colored::Queen<C> || newPiece == Colored::Bishop<C> || newPiece == Colored::Rook<C> ||
-                        newPiece == Colored::Knight<C>;
-                if (!validPromotion) { return false; }
-
-                promote<C>(fromSquare, fromPiece, toSquare, toPiece, newPiece);
-                m_enPassantSquare = s_emptyBoard;
-                return true;
+                this->move<C>(fromSquare, undo.moved, toSquare, undo.captured);
+                if (undo.moved == Colored::Pawn<C> && undo.enPassant == index(toSquare))
+                    togglePiece(Colored::Pawn<opponentColor>, C == Color::White ? toSquare >> 8 : toSquare << 8);
             }
+
+            m_key = undo.key;
+            m_enPassant = undo.enPassant;
+            m_castling = undo.castling;
+            m_halfMoveClock = undo.halfMoveClock;
+            if constexpr (C == Color::Black) m_fullMoveNumber--;
+            m_turn = C;
+            m_history.pop_back();
         }
 
         [[nodiscard]] static constexpr bitboard_t square(int index) noexcept { return s_squares[7 - (index & 7)][index >> 3]; }
@@ -410,6 +842,7 @@ namespace chess
         }
 
         static constexpr const bitboard_t s_emptyBoard = 0x00;
+        static constexpr const bitboard_t s_darkSquares = 0x55AA55AA55AA55AA;
         static constexpr const std::array<Piece, 12> s_piecesList{Piece::WPawn, Piece::WRook, Piece::WKnight, Piece::WBishop, Piece::WQueen,
                                                                   Piece::WKing, Piece::BPawn, Piece::BRook, Piece::BKnight, Piece::BBishop,
                                                                   Piece::BQueen, Piece::BKing};
@@ -435,11 +868,9 @@ namespace chess
                  {0x0000000000000001, 0x0000000000000100, 0x0000000000010000, 0x0000000001000000, 0x0000000100000000, 0x0000010000000000,
                   0x0001000000000000, 0x0100000000000000}}};
 
-        static constexpr const std::array<bitboard_t, 15> s_startingPosition{0xFFFF000000000000, 0x000000000000FF00, 0x0000000000000042,
-                                                                             0x0000000000000081, 0x0000000000000024, 0x0000000000000010,
-                                                                             0x0000000000000008, 0x0000FFFFFFFF0000, 0x000000000000FFFF,
-                                                                             0x00FF000000000000, 0x4200000000000000, 0x8100000000000000,
-                                                                             0x2400000000000000, 0x1000000000000000, 0x8000000000000000};
+        static constexpr const std::array<bitboard_t, 6> s_startingPieces{0x00FF00000000FF00, 0x4200000000000042, 0x8100000000000081,
+                                                                          0x2400000000000024, 0x1000000000000010, 0x0800000000000008};
+        static constexpr const std::array<bitboard_t, 2> s_startingColors{0x000000000000FFFF, 0xFFFF000000000000};
 
         static constexpr const std::array<const std::array<bitboard_t, 8>, 8> s_wPawnMoves{
                 {{0x0000000000008000, 0x0000000000800000, 0x0000000080000000, 0x0000008000000000, 0x0000800000000000, 0x0080000000000000,
@@ -813,12 +1244,23 @@ namespace chess
                   SquareRays{0x0000000000000000, 0x0200000000000000, 0x0200000000000000},
                   SquareRays{0x0000000000000000, 0x0000000000000000, 0x0000000000000000}}}};
     public:
-        constexpr Board() noexcept: m_bitboards(s_startingPosition),
+        constexpr Board() noexcept: m_pieces(s_startingPieces),
+                                    m_colors(s_startingColors),
+                                    m_key(),
+                                    m_pawnKey(computePawnKey()),
+                                    m_halfMoveClock(0),
+                                    m_fullMoveNumber(1),
+                                    m_castling(0x0F),
+                                    m_enPassant(s_noSquare),
                                     m_turn(Color::White),
-                                    m_enPassantSquare(s_emptyBoard),
-                                    m_castling({true, true, true, true}) {}
+                                    m_attacksValid(0),
+                                    m_attacks(),
+                                    m_history()
+        {
+            m_key = computeKey();
+        }
 
-        explicit constexpr Board(const std::string &fenString) { set(fenString); }
+        explicit Board(const std::string &fenString) : Board() { set(fenString); }
 
         [[nodiscard]] std::string fen() const
         {
@@ -855,25 +1297,22 @@ namespace chess
             ss << s_pieceChars[std::to_underlying(m_turn)];
             ss << ' ';
 
-            if (m_castling[0]) ss << 'K';
-            if (m_castling[1]) ss << 'Q';
-            if (m_castling[2]) ss << 'k';
-            if (m_castling[3]) ss << 'q';
-            if (!m_castling[0] && !m_castling[1] && !m_castling[2] && !m_castling[3]) ss << '-';
+            for (int right = 0; right < 4; right++)
+                if (hasCastling(right)) ss << "KQkq"[right];
+            if (m_castling == 0) ss << '-';
 
             ss << ' ';
-            if (m_enPassantSquare == s_emptyBoard) ss << '-';
+            if (enPassantBoard() == s_emptyBoard) ss << '-';
             else
             {
-                auto idx = __builtin_ffsll(m_enPassantSquare) - 1;
+                auto idx = __builtin_ffsll(enPassantBoard()) - 1;
                 auto file = char('a' + (7 - (idx & 7)));
                 auto rank = char('1' + (idx >> 3));
 
                 ss << file << rank;
             }
 
-            // TODO: Half-move clock
-            // TODO: Full-move number
+            ss << ' ' << m_halfMoveClock << ' ' << m_fullMoveNumber;
             return ss.str();
         }
 
@@ -883,47 +1322,48 @@ namespace chess
             std::string token;
             ss >> token;
 
-            m_bitboards = std::array<bitboard_t, 15>();
+            m_pieces = {};
+            m_colors = {};
             int sqr = 63;
             for (auto c: token)
             {
                 switch (c)
                 {
                     case 'r':
-                        bitboard(Piece::BRook) |= square(sqr--);
+                        flip(Piece::BRook, square(sqr--));
                         break;
                     case 'n':
-                        bitboard(Piece::BKnight) |= square(sqr--);
+                        flip(Piece::BKnight, square(sqr--));
                         break;
                     case 'b':
-                        bitboard(Piece::BBishop) |= square(sqr--);
+                        flip(Piece::BBishop, square(sqr--));
                         break;
                     case 'q':
-                        bitboard(Piece::BQueen) |= square(sqr--);
+                        flip(Piece::BQueen, square(sqr--));
                         break;
                     case 'k':
-                        bitboard(Piece::BKing) |= square(sqr--);
+                        flip(Piece::BKing, square(sqr--));
                         break;
                     case 'p':
-                        bitboard(Piece::BPawn) |= square(sqr--);
+                        flip(Piece::BPawn, square(sqr--));
                         break;
                     case 'R':
-                        bitboard(Piece::WRook) |= square(sqr--);
+                        flip(Piece::WRook, square(sqr--));
                         break;
                     case 'N':
-                        bitboard(Piece::WKnight) |= square(sqr--);
+                        flip(Piece::WKnight, square(sqr--));
                         break;
                     case 'B':
-                        bitboard(Piece::WBishop) |= square(sqr--);
+                        flip(Piece::WBishop, square(sqr--));
                         break;
                     case 'Q':
-                        bitboard(Piece::WQueen) |= square(sqr--);
+                        flip(Piece::WQueen, square(sqr--));
                         break;
                     case 'K':
-                        bitboard(Piece::WKing) |= square(sqr--);
+                        flip(Piece::WKing, square(sqr--));
                         break;
                     case 'P':
-                        bitboard(Piece::WPawn) |= square(sqr--);
+                        flip(Piece::WPawn, square(sqr--));
                         break;
                     case '/':
                         break;
@@ -956,76 +1396,407 @@ namespace chess
                 }
             }
 
-            bitboard(Color::White) = bitboard(Piece::WPawn) | bitboard(Piece::WRook) | bitboard(Piece::WKnight) | bitboard(Piece::WBishop) |
-                                     bitboard(Piece::WQueen) | bitboard(Piece::WKing);
-
-            bitboard(Color::Black) = bitboard(Piece::BPawn) | bitboard(Piece::BRook) | bitboard(Piece::BKnight) | bitboard(Piece::BBishop) |
-                                     bitboard(Piece::BQueen) | bitboard(Piece::BKing);
-
-            bitboard(Piece::None) = ~bitboard(Color::White) & ~bitboard(Color::Black);
-
             ss >> token;
             m_turn = token == "w" ? Color::White : Color::Black;
 
             ss >> token;
 
-            m_castling[0] = token.find('K') != std::string::npos;
-            m_castling[1] = token.find('Q') != std::string::npos;
-            m_castling[2] = token.find('k') != std::string::npos;
-            m_castling[3] = token.find('q') != std::string::npos;
+            m_castling = 0;
+            for (int right = 0; right < 4; right++)
+                if (token.find("KQkq"[right]) != std::string::npos) m_castling |= static_cast<unsigned char>(1 << right);
 
             ss >> token;
-            m_enPassantSquare = token == "-" ? s_emptyBoard : square(charFile(token[0]), charRank(token[1]));
+            m_enPassant = token == "-" ? s_noSquare : static_cast<unsigned char>(index(square(charFile(token[0]), charRank(token[1]))));
+
+            // Both counters are optional in the wild, default to a fresh game.
+            unsigned short halfMoveClock = 0;
+            unsigned short fullMoveNumber = 1;
+            if (ss >> halfMoveClock) ss >> fullMoveNumber;
+            m_halfMoveClock = halfMoveClock;
+            m_fullMoveNumber = fullMoveNumber;
+
+            m_key = computeKey();
+            m_pawnKey = computePawnKey();
+            m_attacksValid = 0;
+            m_history.clear();
+        }
+
+        // Sets up a position from the piece on each square, for callers holding a position in some packed form of
+        // their own: no FEN string is built or parsed. The history starts empty.
+        constexpr void set(const std::array<Piece, 64> &pieces, Color turn, unsigned char castling, unsigned char enPassant,
+                           unsigned short halfMoveClock, unsigned short fullMoveNumber) noexcept
+        {
+            m_pieces = {};
+            m_colors = {};
+            for (int sqr = 0; sqr < 64; sqr++)
+                if (pieces[sqr] != Piece::None) flip(pieces[sqr], square(sqr));
+
+            m_turn = turn;
+            m_castling = castling;
+            m_enPassant = enPassant < 64 ? enPassant : s_noSquare;
+            m_halfMoveClock = halfMoveClock;
+            m_fullMoveNumber = fullMoveNumber;
+
+            m_key = computeKey();
+            m_pawnKey = computePawnKey();
+            m_attacksValid = 0;
+            m_history.clear();
+        }
+
+        [[nodiscard]] constexpr State state() const noexcept
+        {
+            return {m_pieces, m_colors, m_key, m_pawnKey, m_halfMoveClock, m_fullMoveNumber, m_castling, m_enPassant, m_turn};
+        }
+
+        // Goes back to a position from state(). The history starts empty.
+        constexpr void set(const State &state) noexcept
+        {
+            m_pieces = state.pieces;
+            m_colors = state.colors;
+            m_key = state.key;
+            m_pawnKey = state.pawnKey;
+            m_halfMoveClock = state.halfMoveClock;
+            m_fullMoveNumber = state.fullMoveNumber;
+            m_castling = state.castling;
+            m_enPassant = state.enPassant;
+            m_turn = state.turn;
+            m_attacksValid = 0;
+            m_history.clear();
+        }
 
-            // TODO: Half-move clock
-            // TODO: Full-move number
+        // As set(state), with the keys of the positions before it, oldest first. Repetitions are only looked for
+        // since the last capture or pawn move, so those keys are all it takes.
+        constexpr void set(const State &state, std::span<const zobrist_t> history)
+        {
+            set(state);
+            m_history.assign(history.begin(), history.end());
         }
 
+        [[nodiscard]] constexpr zobrist_t key() const noexcept { return m_key; }
+
+        // The keys of earlier positions a repetition can still match, those since the last capture or pawn move, oldest
+        // first. With state(), everything set() needs to restore the position.
+        [[nodiscard]] constexpr std::span<const zobrist_t> history() const noexcept
+        {
+            return std::span<const zobrist_t>(m_history).last(std::min<std::size_t>(m_halfMoveClock, m_history.size()));
+        }
+
+        [[nodiscard]] constexpr zobrist_t pawnKey() const noexcept { return m_pawnKey; }
+
+        [[nodiscard]] constexpr unsigned short halfMoveClock() const noexcept { return m_halfMoveClock; }
+
+        [[nodiscard]] constexpr unsigned short fullMoveNumber() const noexcept { return m_fullMoveNumber; }
+
+        // Counts earlier occurrences of the current position, up to limit. Only positions since the last capture or pawn
+        // move can match, and only every other one has the same side to move, so the scan is at most halfMoveClock / 2.
+        [[nodiscard]] constexpr int repetitions(int limit) const noexcept
+        {
+            const auto size = static_cast<int>(m_history.size());
+            const auto end = std::min(static_cast<int>(m_halfMoveClock), size);
+
+            int count = 0;
+            for (int i = 4; i <= end; i += 2)
+                if (m_history[size - i] == m_key && ++count == limit)
+                    break;
+
+            return count;
+        }
+
+        // In-tree repetition for search: any single earlier occurrence is scored as a draw.
+        [[nodiscard]] constexpr bool isRepetition() const noexcept { return m_halfMoveClock >= 4 && repetitions(1) == 1; }
+
+        [[nodiscard]] constexpr bool isThreefoldRepetition() const noexcept { return m_halfMoveClock >= 8 && repetitions(2) == 2; }
+
+        [[nodiscard]] constexpr bool isFiftyMoveDraw() const noexcept { return m_halfMoveClock >= 100; }
+
+        [[nodiscard]] constexpr bool isInsufficientMaterial() const noexcept { return insufficientMaterial(); }
+
+        [[nodiscard]] constexpr Status status() const noexcept
+        {
+            return m_turn == Color::White ? status<Color::White>() : status<Color::Black>();
+        }
+
+        // The move a UCI string names in this position, the null move if it is malformed. A promotion that names no
+        // piece is to a queen.
+        [[nodiscard]] constexpr Move parse(const std::string_view &uciMove) const noexcept
+        {
+            auto onBoard = [&](std::size_t i) { return uciMove[i] >= 'a' && uciMove[i] <= 'h' && uciMove[i + 1] >= '1' && uciMove[i + 1] <= '8'; };
+            if (uciMove.size() < 4 || uciMove.size() > 5 || !onBoard(0) || !onBoard(2)) return {};
+
+            const auto parsed = Move::parse(uciMove);
+            if (uciMove.size() == 5 && parsed.promotion() == Promotion::None) return {};
+            if (uciMove.size() == 4 && promotes(parsed)) return {parsed.from(), parsed.to(), Promotion::Queen};
+            return parsed;
+        }
+
+        // Plays a move in UCI notation if it is legal, leaving the board untouched if not.
+        constexpr Result move(const std::string_view &uciMove) noexcept { return move(parse(uciMove)); }
+
+        // Plays a move if it is legal, leaving the board untouched if not.
+        constexpr Result move(Move played) noexcept { return isLegal(played) ? play(played) : Result::IllegalMove; }
+
+        // Plays a move the caller has already found legal, with isLegal or a LegalMoveCache, and says how the game
+        // stands after it.
+        constexpr Result play(Move played) noexcept
+        {
+            Undo undo;
+            if (m_turn == Color::White) apply<Color::White>(played, undo);
+            else apply<Color::Black>(played, undo);
+
+            switch (status())
+            {
+                case Status::Ongoing:
+                    return Result::LegalMove;
+                case Status::Checkmate:
+                    return m_turn == Color::White ? Result::BlackWin : Result::WhiteWin;
+                case Status::Stalemate:
+                case Status::InsufficientMaterial:
+                case Status::FiftyMoveRule:
+                case Status::Repetition:
+                default:
+                    return Result::Draw;
+            }
+        }
+
+        // Where the piece on from may legally go, empty if it is not the side to move's. Computed on every call;
+        // a caller validating many moves in one position keeps a LegalMoveCache instead.
+        [[nodiscard]] constexpr bitboard_t legalDestinations(int from) const noexcept
+        {
+            const auto fromSquare = square(from);
+            if ((fromSquare & bitboard(m_turn)) == s_emptyBoard) return s_emptyBoard;
+            return m_turn == Color::White ? computeLegal<Color::White>(fromSquare) : computeLegal<Color::Black>(fromSquare);
+        }
+
+        // Whether a pawn move reaches the last rank, where it must promote.
+        [[nodiscard]] constexpr bool promotes(Move move) const noexcept
+        {
+            const auto pawn = m_turn == Color::White ? Piece::WPawn : Piece::BPawn;
+            const auto lastRank = m_turn == Color::White ? Rank::Eight : Rank::One;
+            return piece(square(move.from())) == pawn && squareRank(move.to()) == lastRank;
+        }
+
+        // Whether move can be played here, without changing the board. It promotes exactly when it must.
+        [[nodiscard]] constexpr bool isLegal(Move move) const noexcept
+        {
+            return (legalDestinations(move.from()) & square(move.to())) != s_emptyBoard && promotes(move) == (move.promotion() != Promotion::None);
+        }
+
+        [[nodiscard]] constexpr Color turn() const noexcept { return m_turn; }
+
+        [[nodiscard]] constexpr bitboard_t pieces(Piece p) const noexcept { return bitboard(p); }
+
+        [[nodiscard]] constexpr bitboard_t pieces(Color c) const noexcept { return bitboard(c); }
+
+        [[nodiscard]] constexpr bitboard_t occupied() const noexcept { return all(); }
+
+        // Castling rights in KQkq order.
+        [[nodiscard]] constexpr bool castling(int right) const noexcept { return hasCastling(right); }
+
+        [[nodiscard]] constexpr bitboard_t enPassantSquare() const noexcept { return enPassantBoard(); }
+
+        [[nodiscard]] constexpr Piece pieceAt(int sqr) const noexcept { return piece(square(sqr)); }
+
+        // Every square side C attacks. Computed on the first call after a piece moves, after that it is a lookup.
         template<Color C>
-        [[nodiscard]] constexpr bool checkMate() const noexcept
+        [[nodiscard]] constexpr bitboard_t attackMap() const noexcept
         {
-            if (inCheck<C>())
-                for (int f = 0; f < 8; f++)
-                    for (int r = 0; r < 8; r++)
-                    {
-                        const auto file = File(f);
-                        const auto rank = Rank(r);
-                        const auto sqr = square(file, rank);
-                        if (sqr & bitboard(C))
-                        {
-                            const auto p = piece(sqr);
-                            if (p != Piece::None && moves(p, file, rank)) return false;
-                        }
-                    }
+            if ((m_attacksValid & (C == Color::White ? 1 : 2)) == 0) computeAttacks<C>();
+            return m_attacks[std::to_underlying(C)];
+        }
 
-            return true;
+        // Every square attacked by pieces of kind p.
+        [[nodiscard]] constexpr bitboard_t attackMap(Piece p) const noexcept
+        {
+            if ((std::to_underlying(p) & 8) == 0) (void) attackMap<Color::White>();
+            else (void) attackMap<Color::Black>();
+            return m_attacks[std::to_underlying(p)];
         }
 
-        constexpr Result move(const std::string_view &uciMove) noexcept
+        // Whether side C attacks any of the given squares.
+        template<Color C>
+        [[nodiscard]] constexpr bool isAttacked(bitboard_t squares) const noexcept { return (attackMap<C>() & squares) != s_emptyBoard; }
+
+        // The search knows the side to move at compile time and calls the colour templates below directly, so no
+        // branch on the turn is left at a node. The untemplated versions dispatch on it once for everyone else.
+        template<Color C>
+        [[nodiscard]] constexpr bool inCheck() const noexcept
+        {
+            const auto king = Colored::King<C>;
+            const auto [f, r] = find<king>();
+
+            const auto opponentColor = Colored::Opposite<C>;
+            return attackedBy<opponentColor>(f, r) != s_emptyBoard;
+        }
+
+        [[nodiscard]] constexpr bool inCheck() const noexcept
+        {
+            return m_turn == Color::White ? inCheck<Color::White>() : inCheck<Color::Black>();
+        }
+
+        template<Color C>
+        constexpr void generate(MoveList &list) const noexcept { generateMoves<C, false>(list); }
+
+        constexpr void generate(MoveList &list) const noexcept
         {
-            const auto fromFile = charFile(uciMove[0]);
-            const auto fromRank = charRank(uciMove[1]);
-            const auto toFile = charFile(uciMove[2]);
-            const auto toRank = charRank(uciMove[3]);
+            if (m_turn == Color::White) generate<Color::White>(list);
+            else generate<Color::Black>(list);
+        }
 
-            if (m_turn == Color::White)
+        template<Color C>
+        constexpr void generateCaptures(MoveList &list) const noexcept { generateMoves<C, true>(list); }
+
+        constexpr void generateCaptures(MoveList &list) const noexcept
+        {
+            if (m_turn == Color::White) generateCaptures<Color::White>(list);
+            else generateCaptures<Color::Black>(list);
+        }
+
+        // Number of legal moves, without making any. Checks and pins narrow each piece's destinations to a mask, so
+        // all but king steps and en passant are counted by popcount.
+        template<Color C>
+        [[nodiscard]] constexpr unsigned countLegalMoves() const noexcept
+        {
+            constexpr auto Them = Colored::Opposite<C>;
+            const auto occupied = all();
+            const auto own = bitboard(C);
+            const auto king = bitboard(Colored::King<C>);
+            const auto kingIndex = index(king);
+            const auto kingFile = squareFile(kingIndex);
+            const auto kingRank = squareRank(kingIndex);
+
+            unsigned count = 0;
+            for (auto targets = s_kingMoves[std::to_underlying(kingFile)][std::to_underlying(kingRank)] & ~own; targets; targets &= targets - 1)
+                if (attackers<Them>(targets & -targets, occupied ^ king) == s_emptyBoard) count++;
+
+            const auto checkers = attackers<Them>(king, occupied);
+            if (checkers & (checkers - 1)) return count;
+
+            // Destinations that answer a check: taking the checker or, against a slider, blocking it.
+            const auto evasions = checkers ? checkers | between(kingIndex, index(checkers)) : ~s_emptyBoard;
+
+            // A sniper is the first enemy slider on a line from the king, seen through our own pieces. With exactly one
+            // of ours in between, that piece is pinned and may only move along the line.
+            const auto queens = bitboard(Colored::Queen<Them>);
+            const auto snipers = (rookMoves(kingFile, kingRank, bitboard(Them)) & (bitboard(Colored::Rook<Them>) | queens)) |
+                                 (bishopMoves(kingFile, kingRank, bitboard(Them)) & (bitboard(Colored::Bishop<Them>) | queens));
+            bitboard_t pinned = s_emptyBoard;
+            for (auto remaining = snipers; remaining; remaining &= remaining - 1)
             {
-                const bool moved = moveHelper<Color::White>(fromFile, fromRank, toFile, toRank, uciMove);
-                if (!moved) return Result::IllegalMove;
+                const auto sniper = remaining & -remaining;
+                const auto line = between(kingIndex, index(sniper));
+                const auto blockers = line & occupied;
+                if (blockers == s_emptyBoard || (blockers & (blockers - 1)) || (blockers & own) == s_emptyBoard) continue;
+
+                pinned |= blockers;
+                const auto targets = (line | sniper) & evasions;
+                const auto p = piece(blockers);
+                const auto from = index(blockers);
+                if (p == Colored::Pawn<C>) count += countPawnMoves<C>(blockers, targets);
+                else if (p == Colored::Bishop<C>) count += static_cast<unsigned>(__builtin_popcountll(bishopMoves(squareFile(from), squareRank(from), occupied) & targets));
+                else if (p == Colored::Rook<C>) count += static_cast<unsigned>(__builtin_popcountll(rookMoves(squareFile(from), squareRank(from), occupied) & targets));
+                else if (p == Colored::Queen<C>) count += static_cast<unsigned>(__builtin_popcountll(queenMoves(squareFile(from), squareRank(from), occupied) & targets));
+            }
 
-                m_turn = Color::Black;
-                if (checkMate<Color::Black>()) return Result::WhiteWin;
+            const auto targets = ~own & evasions;
+            count += countPawnMoves<C>(bitboard(Colored::Pawn<C>) & ~pinned, targets);
+            for (auto knights = bitboard(Colored::Knight<C>) & ~pinned; knights; knights &= knights - 1)
+            {
+                const auto from = index(knights & -knights);
+                count += static_cast<unsigned>(__builtin_popcountll(
+                        s_knightMoves[std::to_underlying(squareFile(from))][std::to_underlying(squareRank(from))] & targets));
             }
-            else if (m_turn == Color::Black)
+            for (auto bishops = (bitboard(Colored::Bishop<C>) | bitboard(Colored::Queen<C>)) & ~pinned; bishops; bishops &= bishops - 1)
             {
-                const bool moved = moveHelper<Color::Black>(fromFile, fromRank, toFile, toRank, uciMove);
-                if (!moved) return Result::IllegalMove;
+                const auto from = index(bishops & -bishops);
+                count += static_cast<unsigned>(__builtin_popcountll(bishopMoves(squareFile(from), squareRank(from), occupied) & targets));
+            }
+            for (auto rooks = (bitboard(Colored::Rook<C>) | bitboard(Colored::Queen<C>)) & ~pinned; rooks; rooks &= rooks - 1)
+            {
+                const auto from = index(rooks & -rooks);
+                count += static_cast<unsigned>(__builtin_popcountll(rookMoves(squareFile(from), squareRank(from), occupied) & targets));
+            }
 
-                m_turn = Color::White;
-                if (checkMate<Color::White>()) return Result::BlackWin;
+            // En passant can expose the king along the rank of both pawns, so it is tried on a scratch occupancy.
+            if (m_enPassant != s_noSquare)
+            {
+                const auto target = enPassantBoard();
+                const auto captured = C == Color::White ? target >> 8 : target << 8;
+                const auto &sources = C == Color::White ? s_bPawnAttacks : s_wPawnAttacks;
+                for (auto pawns = sources[std::to_underlying(squareFile(m_enPassant))][std::to_underlying(squareRank(m_enPassant))] &
+                                  bitboard(Colored::Pawn<C>); pawns; pawns &= pawns - 1)
+                    if (kingSafeAfter<C>(pawns & -pawns, target, captured)) count++;
             }
 
-            return Result::LegalMove;
+            if (checkers == s_emptyBoard) count += static_cast<unsigned>(__builtin_popcountll(castlingDestinations<C>()));
+            return count;
+        }
+
+        [[nodiscard]] constexpr unsigned countLegalMoves() const noexcept
+        {
+            return m_turn == Color::White ? countLegalMoves<Color::White>() : countLegalMoves<Color::Black>();
+        }
+
+        // Plays a move from generate(). If it would leave the mover's king in check the board is restored and false
+        // returned, otherwise undo receives what unmake() needs. C must be the side to move.
+        template<Color C>
+        constexpr bool make(Move move, Undo &undo) noexcept
+        {
+            apply<C>(move, undo);
+            if (!inCheck<C>()) return true;
+            revert<C>(move, undo);
+            return false;
+        }
+
+        constexpr bool make(Move move, Undo &undo) noexcept
+        {
+            return m_turn == Color::White ? make<Color::White>(move, undo) : make<Color::Black>(move, undo);
+        }
+
+        // C is the side that made the move, the opponent of the side now to move.
+        template<Color C>
+        constexpr void unmake(Move move, const Undo &undo) noexcept { revert<C>(move, undo); }
+
+        constexpr void unmake(Move move, const Undo &undo) noexcept
+        {
+            if (m_turn == Color::White) unmake<Color::Black>(move, undo);
+            else unmake<Color::White>(move, undo);
+        }
+
+        // Passes the move for null-move pruning. The halfmove clock restarts so no repetition is seen across it.
+        template<Color C>
+        constexpr void makeNull(Undo &undo) noexcept
+        {
+            undo = {m_key, m_enPassant, m_castling, m_halfMoveClock, Piece::None, Piece::None};
+            m_history.push_back(m_key);
+            setEnPassant(s_emptyBoard);
+            m_halfMoveClock = 0;
+            if constexpr (C == Color::Black) m_fullMoveNumber++;
+            m_turn = Colored::Opposite<C>;
+            m_key ^= Zobrist::Side;
+        }
+
+        constexpr void makeNull(Undo &undo) noexcept
+        {
+            if (m_turn == Color::White) makeNull<Color::White>(undo);
+            else makeNull<Color::Black>(undo);
+        }
+
+        // C is the side that passed.
+        template<Color C>
+        constexpr void unmakeNull(const Undo &undo) noexcept
+        {
+            m_turn = C;
+            if constexpr (C == Color::Black) m_fullMoveNumber--;
+            m_key = undo.key;
+            m_enPassant = undo.enPassant;
+            m_halfMoveClock = undo.halfMoveClock;
+            m_history.pop_back();
+        }
+
+        constexpr void unmakeNull(const Undo &undo) noexcept
+        {
+            if (m_turn == Color::White) unmakeNull<Color::Black>(undo);
+            else unmakeNull<Color::White>(undo);
         }
 
         [[nodiscard]] std::string display() const noexcept
@@ -0,0 +1,54 @@
+#ifndef CHESS_ENGINE_LEGAL_MOVE_CACHE_H
+#define CHESS_ENGINE_LEGAL_MOVE_CACHE_H
+
+#include <array>
+#include <cstddef>
+
+#include "Board.hpp"
+#include "Move.h"
+#include "Zobrist.h"
+
+namespace chess
+{
+    // Legal destinations by origin square for one position, filled in per square on demand, for a caller that
+    // validates many moves in the same position: premoves, move hints, a client resending its move. The position is
+    // told apart by its key, which covers everything legality depends on, so the cache needs no invalidation and one
+    // cache serves any number of boards. Kept apart from Board so that boards stay small to copy.
+    class LegalMoveCache
+    {
+        using bitboard_t = Board::bitboard_t;
+
+        std::array<bitboard_t, 64> m_destinations;
+        zobrist_t m_key;
+        bitboard_t m_built; // Origin squares whose entry holds for m_key.
+
+    public:
+        LegalMoveCache() noexcept: m_destinations(), m_key(0), m_built(0) {}
+
+        [[nodiscard]] bitboard_t destinations(const Board &board, int from) noexcept
+        {
+            if (board.key() != m_key)
+            {
+                m_key = board.key();
+                m_built = 0;
+            }
+
+            const auto fromSquare = bitboard_t(1) << from;
+            if ((m_built & fromSquare) == 0)
+            {
+                m_built |= fromSquare;
+                m_destinations[static_cast<std::size_t>(from)] = board.legalDestinations(from);
+            }
+            return m_destinations[static_cast<std::size_t>(from)];
+        }
+
+        // As Board::isLegal, a lookup once the origin square has been asked about in the position.
+        [[nodiscard]] bool isLegal(const Board &board, Move move) noexcept
+        {
+            return (destinations(board, move.from()) & bitboard_t(1) << move.to()) != 0 &&
+                   board.promotes(move) == (move.promotion() != Promotion::None);
+        }
+    };
+} // namespace chess
+
+#endif // CHESS_ENGINE_LEGAL_MOVE_CACHE_H
@@ -0,0 +1,125 @@
+#ifndef CHESS_ENGINE_MOVE_H
+#define CHESS_ENGINE_MOVE_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "File.h"
+#include "Piece.h"
+#include "Rank.h"
+
+namespace chess
+{
+    // Squares are bit indices into Board's bitboards: h1 = 0, a1 = 7, h8 = 56, a8 = 63.
+    constexpr int squareIndex(File f, Rank r) noexcept { return std::to_underlying(r) * 8 + (7 - std::to_underlying(f)); }
+
+    constexpr File squareFile(int square) noexcept { return File(7 - (square & 7)); }
+
+    constexpr Rank squareRank(int square) noexcept { return Rank(square >> 3); }
+
+    enum class Promotion : unsigned char { None, Knight, Bishop, Rook, Queen };
+
+    // A move packed into 16 bits: origin (6), destination (6) and promotion (3). Castling and en passant are not
+    // flagged, they follow from the board: a king moving two files or a pawn moving onto the en passant square.
+    class Move
+    {
+        std::uint16_t m_data;
+
+    public:
+        constexpr Move() noexcept: m_data(0) {}
+
+        constexpr Move(int from, int to, Promotion promotion = Promotion::None) noexcept
+                : m_data(static_cast<std::uint16_t>(from | (to << 6) | (std::to_underlying(promotion) << 12))) {}
+
+        [[nodiscard]] static constexpr Move fromData(std::uint16_t data) noexcept
+        {
+            Move move;
+            move.m_data = data;
+            return move;
+        }
+
+        [[nodiscard]] constexpr int from() const noexcept { return m_data & 0x3F; }
+
+        [[nodiscard]] constexpr int to() const noexcept { return (m_data >> 6) & 0x3F; }
+
+        [[nodiscard]] constexpr Promotion promotion() const noexcept { return Promotion(m_data >> 12); }
+
+        [[nodiscard]] constexpr std::uint16_t data() const noexcept { return m_data; }
+
+        [[nodiscard]] constexpr bool isNull() const noexcept { return m_data == 0; }
+
+        constexpr bool operator==(const Move &other) const noexcept = default;
+
+        [[nodiscard]] std::string uci() const
+        {
+            if (isNull()) return "0000";
+
+            std::string s{char('a' + std::to_underlying(squareFile(from()))), char('1' + std::to_underlying(squareRank(from()))),
+                          char('a' + std::to_underlying(squareFile(to()))), char('1' + std::to_underlying(squareRank(to())))};
+            constexpr std::array<char, 5> promotionChars{' ', 'n', 'b', 'r', 'q'};
+            if (promotion() != Promotion::None) s += promotionChars[std::to_underlying(promotion())];
+            return s;
+        }
+
+        // Parses the squares and promotion only; whether the move is legal is for the board to decide.
+        [[nodiscard]] static constexpr Move parse(std::string_view uciMove) noexcept
+        {
+            if (uciMove.size() < 4) return {};
+
+            const auto from = squareIndex(charFile(uciMove[0]), charRank(uciMove[1]));
+            const auto to = squareIndex(charFile(uciMove[2]), charRank(uciMove[3]));
+            auto promotion = Promotion::None;
+            if (uciMove.size() > 4)
+            {
+                switch (uciMove[4])
+                {
+                    case 'n':
+                        promotion = Promotion::Knight;
+                        break;
+                    case 'b':
+                        promotion = Promotion::Bishop;
+                        break;
+                    case 'r':
+                        promotion = Promotion::Rook;
+                        break;
+                    case 'q':
+                        promotion = Promotion::Queen;
+                        break;
+                    default:
+                        break;
+                }
+            }
+            return {from, to, promotion};
+        }
+    };
+
+    // Fixed-capacity list, no legal position has more than 218 moves.
+    class MoveList
+    {
+        std::array<Move, 256> m_moves;
+        unsigned m_size;
+
+    public:
+        constexpr MoveList() noexcept: m_moves(), m_size(0) {}
+
+        constexpr void push(Move move) noexcept { m_moves[m_size++] = move; }
+
+        [[nodiscard]] constexpr unsigned size() const noexcept { return m_size; }
+
+        [[nodiscard]] constexpr bool empty() const noexcept { return m_size == 0; }
+
+        constexpr void clear() noexcept { m_size = 0; }
+
+        [[nodiscard]] constexpr Move &operator[](unsigned i) noexcept { return m_moves[i]; }
+
+        [[nodiscard]] constexpr const Move &operator[](unsigned i) const noexcept { return m_moves[i]; }
+
+        [[nodiscard]] constexpr const Move *begin() const noexcept { return m_moves.data(); }
+
+        [[nodiscard]] constexpr const Move *end() const noexcept { return m_moves.data() + m_size; }
+    };
+} // namespace chess
+
+#endif // CHESS_ENGINE_MOVE_H
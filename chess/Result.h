@@ -8,6 +8,11 @@ namespace chess
         LegalMove, IllegalMove, WhiteWin, BlackWin, Draw
     };
 
+    enum class Status : unsigned char
+    {
+        Ongoing, Checkmate, Stalemate, InsufficientMaterial, FiftyMoveRule, Repetition
+    };
+
     constexpr bool GameOver(Result result) noexcept
     {
         return result == Result::WhiteWin || result == Result::BlackWin || result == Result::Draw;
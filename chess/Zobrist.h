@@ -0,0 +1,48 @@
+#ifndef CHESS_ENGINE_ZOBRIST_H
+#define CHESS_ENGINE_ZOBRIST_H
+
+#include <array>
+#include <cstdint>
+
+#include "Piece.h"
+
+namespace chess
+{
+    using zobrist_t = std::uint64_t;
+
+    namespace Zobrist
+    {
+        // 15 piece slots (indexed like Board's bitboards) x 64 squares, 4 castling rights, 8 en passant files, side to move.
+        constexpr const int PieceKeys = 15 * 64;
+        constexpr const int CastlingKeys = 4;
+        constexpr const int EnPassantKeys = 8;
+        constexpr const int KeyCount = PieceKeys + CastlingKeys + EnPassantKeys + 1;
+
+        // Keys are produced by splitmix64 at compile time so they are identical across builds and platforms.
+        consteval std::array<zobrist_t, KeyCount> generate(zobrist_t seed)
+        {
+            std::array<zobrist_t, KeyCount> keys{};
+            for (auto &key: keys)
+            {
+                seed += 0x9E3779B97F4A7C15;
+                zobrist_t z = seed;
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+                key = z ^ (z >> 31);
+            }
+            return keys;
+        }
+
+        constexpr const std::array<zobrist_t, KeyCount> Keys = generate(0x2545F4914F6CDD1D);
+
+        constexpr zobrist_t piece(Piece p, int square) noexcept { return Keys[std::to_underlying(p) * 64 + square]; }
+
+        constexpr zobrist_t castling(int right) noexcept { return Keys[PieceKeys + right]; }
+
+        constexpr zobrist_t enPassant(int file) noexcept { return Keys[PieceKeys + CastlingKeys + file]; }
+
+        constexpr const zobrist_t Side = Keys[PieceKeys + CastlingKeys + EnPassantKeys];
+    }
+} // namespace chess
+
+#endif // CHESS_ENGINE_ZOBRIST_H
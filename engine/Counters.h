@@ -0,0 +1,109 @@
+#ifndef CHESS_ENGINE_COUNTERS_H
+#define CHESS_ENGINE_COUNTERS_H
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "config.h"
+
+namespace engine
+{
+    enum class Counter : unsigned char
+    {
+        QuiescenceNodes, TableProbes, TableHits, TableCutoffs, BetaCutoffs, FirstMoveCutoffs, NullMoveReSearches, LmrReSearches, PawnProbes,
+        PawnHits,
+
+        Count
+    };
+
+    constexpr const std::array<std::string_view, std::to_underlying(Counter::Count)> CounterNames{
+            "qnodes", "ttProbes", "ttHits", "ttCutoffs", "betaCutoffs", "firstMoveCutoffs", "nullMoveReSearches", "lmrReSearches", "pawnProbes",
+            "pawnHits"};
+
+    // Plain per-thread integers, only summed after the threads are done, so the hot path never touches shared memory.
+    // Configured with SEARCH_STATS off, the storage is empty and every increment compiles to nothing.
+    class Counters
+    {
+        static constexpr const bool s_enabled = SEARCH_STATS;
+
+        std::array<std::uint64_t, s_enabled ? std::to_underlying(Counter::Count) : 0> m_values{};
+
+    public:
+        [[nodiscard]] static constexpr bool enabled() noexcept { return s_enabled; }
+
+        constexpr void increment(Counter counter) noexcept
+        {
+            if constexpr (s_enabled) m_values[std::to_underlying(counter)]++;
+        }
+
+        [[nodiscard]] constexpr std::uint64_t operator[](Counter counter) const noexcept
+        {
+            if constexpr (s_enabled) return m_values[std::to_underlying(counter)];
+            else return 0;
+        }
+
+        constexpr Counters &operator+=(const Counters &other) noexcept
+        {
+            for (std::size_t i = 0; i < m_values.size(); i++)
+                m_values[i] += other.m_values[i];
+            return *this;
+        }
+    };
+
+    // Counters summed over all threads of one search, with the ratios worth looking at while tuning.
+    struct SearchStatistics
+    {
+        std::uint64_t nodes = 0;
+        Counters counters{};
+        std::vector<std::uint64_t> iterationNodes{}; // Main thread nodes spent on each completed depth.
+
+        [[nodiscard]] static double ratio(std::uint64_t part, std::uint64_t whole) noexcept { return whole ? double(part) / double(whole) : 0.0; }
+
+        [[nodiscard]] double firstMoveCutoffRate() const noexcept
+        {
+            return ratio(counters[Counter::FirstMoveCutoffs], counters[Counter::BetaCutoffs]);
+        }
+
+        [[nodiscard]] double tableHitRate() const noexcept { return ratio(counters[Counter::TableHits], counters[Counter::TableProbes]); }
+
+        [[nodiscard]] double pawnHitRate() const noexcept { return ratio(counters[Counter::PawnHits], counters[Counter::PawnProbes]); }
+
+        // Geometric mean of the growth from one iteration to the next.
+        [[nodiscard]] double branchingFactor() const noexcept
+        {
+            if (iterationNodes.size() < 2 || iterationNodes.front() == 0) return 0.0;
+            return std::pow(double(iterationNodes.back()) / double(iterationNodes.front()), 1.0 / double(iterationNodes.size() - 1));
+        }
+
+        [[nodiscard]] std::string json() const
+        {
+            std::ostringstream out;
+            out << "{\"nodes\":" << nodes;
+            for (std::size_t i = 0; i < CounterNames.size(); i++)
+                out << ",\"" << CounterNames[i] << "\":" << counters[Counter(i)];
+            out << ",\"firstMoveCutoffRate\":" << firstMoveCutoffRate() << ",\"ttHitRate\":" << tableHitRate()
+                << ",\"pawnHitRate\":" << pawnHitRate()
+                << ",\"branchingFactor\":" << branchingFactor() << '}';
+            return out.str();
+        }
+
+        // For a UCI "info string" line.
+        [[nodiscard]] std::string summary() const
+        {
+            std::ostringstream out;
+            out << "nodes " << nodes;
+            for (std::size_t i = 0; i < CounterNames.size(); i++)
+                out << ' ' << CounterNames[i] << ' ' << counters[Counter(i)];
+            out << " fmc " << firstMoveCutoffRate() << " ebf " << branchingFactor();
+            return out.str();
+        }
+    };
+} // namespace engine
+
+#endif // CHESS_ENGINE_COUNTERS_H
@@ -0,0 +1,187 @@
+#ifndef CHESS_ENGINE_EVALUATION_H
+#define CHESS_ENGINE_EVALUATION_H
+
+#include <array>
+
+#include "PawnTable.h"
+#include "Score.h"
+#include "chess/Board.hpp"
+
+namespace engine
+{
+    namespace Evaluation
+    {
+        using table_t = std::array<score_t, 64>;
+
+        // Indexed by Piece & 7: pawn, knight, rook, bishop, queen, king.
+        constexpr const std::array<score_t, 7> PieceValues{0, 100, 320, 500, 330, 900, 0};
+
+        constexpr score_t value(chess::Piece p) noexcept { return PieceValues[std::to_underlying(p) & 7]; }
+
+        // Piece-square tables from the Simplified Evaluation Function, written from White's side with a8 first.
+        constexpr const table_t PawnTable{
+                0, 0, 0, 0, 0, 0, 0, 0,
+                50, 50, 50, 50, 50, 50, 50, 50,
+                10, 10, 20, 30, 30, 20, 10, 10,
+                5, 5, 10, 25, 25, 10, 5, 5,
+                0, 0, 0, 20, 20, 0, 0, 0,
+                5, -5, -10, 0, 0, -10, -5, 5,
+                5, 10, 10, -20, -20, 10, 10, 5,
+                0, 0, 0, 0, 0, 0, 0, 0};
+
+        constexpr const table_t KnightTable{
+                -50, -40, -30, -30, -30, -30, -40, -50,
+                -40, -20, 0, 0, 0, 0, -20, -40,
+                -30, 0, 10, 15, 15, 10, 0, -30,
+                -30, 5, 15, 20, 20, 15, 5, -30,
+                -30, 0, 15, 20, 20, 15, 0, -30,
+                -30, 5, 10, 15, 15, 10, 5, -30,
+                -40, -20, 0, 5, 5, 0, -20, -40,
+                -50, -40, -30, -30, -30, -30, -40, -50};
+
+        constexpr const table_t BishopTable{
+                -20, -10, -10, -10, -10, -10, -10, -20,
+                -10, 0, 0, 0, 0, 0, 0, -10,
+                -10, 0, 5, 10, 10, 5, 0, -10,
+                -10, 5, 5, 10, 10, 5, 5, -10,
+                -10, 0, 10, 10, 10, 10, 0, -10,
+                -10, 10, 10, 10, 10, 10, 10, -10,
+                -10, 5, 0, 0, 0, 0, 5, -10,
+                -20, -10, -10, -10, -10, -10, -10, -20};
+
+        constexpr const table_t RookTable{
+                0, 0, 0, 0, 0, 0, 0, 0,
+                5, 10, 10, 10, 10, 10, 10, 5,
+                -5, 0, 0, 0, 0, 0, 0, -5,
+                -5, 0, 0, 0, 0, 0, 0, -5,
+                -5, 0, 0, 0, 0, 0, 0, -5,
+                -5, 0, 0, 0, 0, 0, 0, -5,
+                -5, 0, 0, 0, 0, 0, 0, -5,
+                0, 0, 0, 5, 5, 0, 0, 0};
+
+        constexpr const table_t QueenTable{
+                -20, -10, -10, -5, -5, -10, -10, -20,
+                -10, 0, 0, 0, 0, 0, 0, -10,
+                -10, 0, 5, 5, 5, 5, 0, -10,
+                -5, 0, 5, 5, 5, 5, 0, -5,
+                0, 0, 5, 5, 5, 5, 0, -5,
+                -10, 5, 5, 5, 5, 5, 0, -10,
+                -10, 0, 5, 0, 0, 0, 0, -10,
+                -20, -10, -10, -5, -5, -10, -10, -20};
+
+        constexpr const table_t KingMiddleTable{
+                -30, -40, -40, -50, -50, -40, -40, -30,
+                -30, -40, -40, -50, -50, -40, -40, -30,
+                -30, -40, -40, -50, -50, -40, -40, -30,
+                -30, -40, -40, -50, -50, -40, -40, -30,
+                -20, -30, -30, -40, -40, -30, -30, -20,
+                -10, -20, -20, -20, -20, -20, -20, -10,
+                20, 20, 0, 0, 0, 0, 20, 20,
+                20, 30, 10, 0, 0, 10, 30, 20};
+
+        constexpr const table_t KingEndTable{
+                -50, -40, -30, -20, -20, -30, -40, -50,
+                -30, -20, -10, 0, 0, -10, -20, -30,
+                -30, -10, 20, 30, 30, 20, -10, -30,
+                -30, -10, 30, 40, 40, 30, -10, -30,
+                -30, -10, 30, 40, 40, 30, -10, -30,
+                -30, -10, 20, 30, 30, 20, -10, -30,
+                -30, -30, 0, 0, 0, 0, -30, -30,
+                -50, -30, -30, -30, -30, -30, -30, -50};
+
+        // Maps a bit index to the tables' layout; Black reads them mirrored.
+        template<chess::Color C>
+        constexpr int tableIndex(int square) noexcept
+        {
+            const auto file = 7 - (square & 7);
+            const auto rank = square >> 3;
+            return (C == chess::Color::White ? 7 - rank : rank) * 8 + file;
+        }
+
+        // Value plus placement for every piece but the king, which is tapered on its own.
+        consteval std::array<table_t, 15> buildPieceSquares()
+        {
+            std::array<table_t, 15> tables{};
+            const std::array<const table_t *, 7> sources{nullptr, &PawnTable, &KnightTable, &RookTable, &BishopTable, &QueenTable, nullptr};
+            for (int type = 1; type <= 5; type++)
+            {
+                for (int sq = 0; sq < 64; sq++)
+                {
+                    tables[type][sq] = PieceValues[type] + (*sources[type])[tableIndex<chess::Color::White>(sq)];
+                    tables[type + 8][sq] = PieceValues[type] + (*sources[type])[tableIndex<chess::Color::Black>(sq)];
+                }
+            }
+            return tables;
+        }
+
+        constexpr const std::array<table_t, 15> PieceSquares = buildPieceSquares();
+
+        // Knights and bishops count 1, rooks 2, queens 4; 24 is the full starting set.
+        constexpr const int MaxPhase = 24;
+
+        template<chess::Color C>
+        constexpr score_t material(const chess::Board &board, int &phase) noexcept
+        {
+            using chess::Colored::Pawn, chess::Colored::Knight, chess::Colored::Bishop, chess::Colored::Rook, chess::Colored::Queen;
+
+            score_t score = 0;
+            for (const auto p: {Pawn<C>, Knight<C>, Bishop<C>, Rook<C>, Queen<C>})
+            {
+                const auto &table = PieceSquares[std::to_underlying(p)];
+                for (auto bb = board.pieces(p); bb; bb &= bb - 1)
+                    score += table[__builtin_ctzll(bb)];
+            }
+
+            phase += __builtin_popcountll(board.pieces(Knight<C>) | board.pieces(Bishop<C>)) +
+                     2 * __builtin_popcountll(board.pieces(Rook<C>)) + 4 * __builtin_popcountll(board.pieces(Queen<C>));
+            return score;
+        }
+
+        template<chess::Color C>
+        constexpr score_t king(const chess::Board &board, int phase) noexcept
+        {
+            const auto index = tableIndex<C>(__builtin_ctzll(board.pieces(chess::Colored::King<C>)));
+            return (KingMiddleTable[index] * phase + KingEndTable[index] * (MaxPhase - phase)) / MaxPhase;
+        }
+
+        constexpr const score_t ShieldNear = 12, ShieldFar = 6;
+
+        // Middlegame bonus for own pawns in the two ranks in front of a king still on its back rank. It depends on
+        // the king, so it is not part of the cached pawn entry, but it is only two masks and two counts.
+        template<chess::Color C>
+        constexpr score_t shield(const chess::Board &board) noexcept
+        {
+            const auto king = board.pieces(chess::Colored::King<C>);
+            const auto backRank = C == chess::Color::White ? 0x00000000000000FFull : 0xFF00000000000000ull;
+            if ((king & backRank) == 0) return 0;
+
+            const auto near = Pawns::forward<C>(king | Pawns::sideways(king));
+            const auto pawns = board.pieces(chess::Colored::Pawn<C>);
+            return ShieldNear * __builtin_popcountll(pawns & near) + ShieldFar * __builtin_popcountll(pawns & Pawns::forward<C>(near));
+        }
+
+        // Static evaluation from the point of view of C, the side to move, with the pawn structure terms from pawns.
+        template<chess::Color C>
+        constexpr score_t evaluate(const chess::Board &board, const PawnEntry &pawns) noexcept
+        {
+            constexpr auto Them = chess::Colored::Opposite<C>;
+            int phase = 0;
+            score_t score = material<C>(board, phase) - material<Them>(board, phase);
+            if (phase > MaxPhase) phase = MaxPhase;
+
+            const auto middlegame = pawns.middlegame + shield<chess::Color::White>(board) - shield<chess::Color::Black>(board);
+            const auto structure = (middlegame * phase + pawns.endgame * (MaxPhase - phase)) / MaxPhase;
+            return score + king<C>(board, phase) - king<Them>(board, phase) + (C == chess::Color::White ? structure : -structure);
+        }
+
+        template<chess::Color C>
+        constexpr score_t evaluate(const chess::Board &board) noexcept { return evaluate<C>(board, Pawns::analyse(board)); }
+
+        constexpr score_t evaluate(const chess::Board &board) noexcept
+        {
+            return board.turn() == chess::Color::White ? evaluate<chess::Color::White>(board) : evaluate<chess::Color::Black>(board);
+        }
+    }
+} // namespace engine
+
+#endif // CHESS_ENGINE_EVALUATION_H
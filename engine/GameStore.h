@@ -0,0 +1,393 @@
+#ifndef CHESS_ENGINE_GAME_STORE_H
+#define CHESS_ENGINE_GAME_STORE_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "TrainingData.h"
+#include "chess/Board.hpp"
+#include "chess/LegalMoveCache.h"
+
+namespace engine
+{
+    // Fixed-size objects in pages that never move, addressed by index. Freed indices are reused before a page is
+    // added and the free list always has room for every index, so adding a page is the only allocation.
+    template<typename T, std::size_t PageSize>
+    class Slab
+    {
+        std::vector<std::unique_ptr<T[]>> m_pages;
+        std::vector<std::uint32_t> m_free;
+        std::uint32_t m_used; // Indices handed out at least once.
+
+        void grow()
+        {
+            m_pages.push_back(std::make_unique<T[]>(PageSize));
+            m_free.reserve(capacity());
+        }
+
+    public:
+        Slab() : m_pages(), m_free(), m_used(0) {}
+
+        [[nodiscard]] std::uint32_t allocate()
+        {
+            if (!m_free.empty())
+            {
+                const auto index = m_free.back();
+                m_free.pop_back();
+                return index;
+            }
+            if (m_used == capacity()) grow();
+            return m_used++;
+        }
+
+        void release(std::uint32_t index) { m_free.push_back(index); }
+
+        void reserve(std::size_t count)
+        {
+            while (capacity() < count)
+                grow();
+        }
+
+        [[nodiscard]] T &operator[](std::uint32_t index) noexcept { return m_pages[index / PageSize][index % PageSize]; }
+
+        [[nodiscard]] const T &operator[](std::uint32_t index) const noexcept { return m_pages[index / PageSize][index % PageSize]; }
+
+        [[nodiscard]] std::size_t capacity() const noexcept { return m_pages.size() * PageSize; }
+
+        [[nodiscard]] std::size_t bytes() const noexcept { return capacity() * (sizeof(T) + sizeof(std::uint32_t)); }
+    };
+
+    // Live games for a server hosting a great many at once. A game is its current position as a Board::State, its
+    // starting position in the 32-byte training format and its moves at 16 bits each, in 64-byte chunks linked from
+    // the game. Games and chunks both come from slabs, so a game is 144 bytes and a chunk per 30 plies, and an id is
+    // a slot index with a generation that catches ids of erased games.
+    //
+    // A move is played by copying the current position into one scratch board, playing it there and copying it
+    // back, which allocates nothing once the slabs have room. Seeing a repetition takes the keys of the positions
+    // since the last capture or pawn move, so each game also keeps those, seven to a 64-byte chunk, and hands them
+    // back when the clock is reset: at most 100 keys, however long the game.
+    // Not thread-safe: a server with several I/O threads gives each a store of its own.
+    class GameStore
+    {
+        static constexpr const std::size_t s_pageSize = 4096;
+        static constexpr const std::size_t s_chunkMoves = 30;
+        static constexpr const std::size_t s_chunkKeys = 7;
+        static constexpr const std::uint32_t s_none = ~std::uint32_t(0);
+
+        struct Chunk
+        {
+            std::array<std::uint16_t, s_chunkMoves> moves;
+            std::uint32_t next;
+        };
+
+        struct KeyChunk
+        {
+            std::array<chess::zobrist_t, s_chunkKeys> keys;
+            std::uint32_t next;
+        };
+
+        struct Game
+        {
+            chess::Board::State current;
+            PackedPosition start;
+            std::uint32_t generation; // Odd while the slot holds a game.
+            std::uint32_t plies;
+            std::uint32_t first;      // Chunks, s_none before the first move.
+            std::uint32_t last;
+            std::uint32_t keys;       // Key chunks newest first, s_none when there are no keys.
+            std::uint16_t keyCount;   // Positions since the last capture or pawn move, the current one aside.
+            chess::Result result;     // LegalMove while the game is in play.
+        };
+
+        static_assert(sizeof(Chunk) == 64);
+        static_assert(sizeof(KeyChunk) == 64);
+        static_assert(sizeof(Game) == 144);
+
+        Slab<Game, s_pageSize> m_games;
+        Slab<Chunk, s_pageSize> m_chunks;
+        Slab<KeyChunk, s_pageSize> m_keyChunks;
+        std::size_t m_size;
+        chess::Board m_board;
+        std::vector<chess::zobrist_t> m_history; // The loaded game's keys, oldest first.
+        chess::LegalMoveCache m_legal; // A move checked with isLegal is not worked out again when it is played.
+
+        // Only an odd generation names a game: a slot never used has generation 0 and an erased one an even one.
+        [[nodiscard]] std::uint32_t slot(std::uint64_t id) const noexcept
+        {
+            const auto index = static_cast<std::uint32_t>(id);
+            const auto generation = id >> 32;
+            return (generation & 1) && index < m_games.capacity() && m_games[index].generation == generation ? index : s_none;
+        }
+
+        [[nodiscard]] const Game &game(std::uint64_t id) const
+        {
+            const auto index = slot(id);
+            if (index == s_none) throw std::out_of_range("unknown game " + std::to_string(id));
+            return m_games[index];
+        }
+
+        // Training result convention, White's side: a game still in play reads as a draw.
+        [[nodiscard]] static std::uint8_t outcome(chess::Result result) noexcept
+        {
+            return result == chess::Result::WhiteWin ? 2 : result == chess::Result::BlackWin ? 0 : 1;
+        }
+
+        template<typename Visit>
+        void forEachMove(const Game &game, Visit visit) const
+        {
+            auto remaining = game.plies;
+            for (auto chunk = game.first; remaining > 0; chunk = m_chunks[chunk].next)
+            {
+                const auto &moves = m_chunks[chunk].moves;
+                const auto count = std::min<std::uint32_t>(remaining, s_chunkMoves);
+                for (std::uint32_t i = 0; i < count; i++)
+                    visit(chess::Move::fromData(moves[i]));
+                remaining -= count;
+            }
+        }
+
+        void releaseKeys(Game &game)
+        {
+            for (auto chunk = game.keys; chunk != s_none; chunk = m_keyChunks[chunk].next)
+                m_keyChunks.release(chunk);
+            game.keys = s_none;
+            game.keyCount = 0;
+        }
+
+        // The game's keys into m_history, oldest first. The newest chunk is the only one that may be partly full.
+        void gatherKeys(const Game &game)
+        {
+            m_history.resize(game.keyCount);
+            auto end = game.keyCount;
+            for (auto chunk = game.keys; chunk != s_none; chunk = m_keyChunks[chunk].next)
+            {
+                const auto begin = static_cast<std::uint16_t>((end - 1) / s_chunkKeys * s_chunkKeys);
+                std::copy_n(m_keyChunks[chunk].keys.begin(), end - begin, m_history.begin() + begin);
+                end = begin;
+            }
+        }
+
+        void load(const Game &game)
+        {
+            gatherKeys(game);
+            m_board.set(game.current, m_history);
+        }
+
+        // Plays on the scratch board, which holds the game's current position. The game itself only changes once
+        // both chunks it may need are allocated, so a failed allocation leaves it as it was.
+        chess::Result play(Game &game, chess::Move move)
+        {
+            if (!m_legal.isLegal(m_board, move)) return chess::Result::IllegalMove;
+            const auto previous = m_board.key();
+            const auto result = m_board.play(move);
+            const bool reversible = m_board.halfMoveClock() != 0;
+
+            const auto offset = game.plies % s_chunkMoves;
+            const auto keyOffset = game.keyCount % s_chunkKeys;
+            const auto keyChunk = reversible && keyOffset == 0 ? m_keyChunks.allocate() : s_none;
+            auto chunk = s_none;
+            try
+            {
+                if (offset == 0) chunk = m_chunks.allocate();
+            }
+            catch (...)
+            {
+                if (keyChunk != s_none) m_keyChunks.release(keyChunk);
+                throw;
+            }
+
+            if (offset == 0)
+            {
+                m_chunks[chunk].next = s_none;
+                if (game.plies == 0) game.first = chunk;
+                else m_chunks[game.last].next = chunk;
+                game.last = chunk;
+            }
+            m_chunks[game.last].moves[offset] = move.data();
+            game.plies++;
+
+            if (!reversible) releaseKeys(game);
+            else
+            {
+                if (keyChunk != s_none)
+                {
+                    m_keyChunks[keyChunk].next = game.keys;
+                    game.keys = keyChunk;
+                }
+                m_keyChunks[game.keys].keys[keyOffset] = previous;
+                game.keyCount++;
+            }
+
+            game.result = result;
+            game.current = m_board.state();
+            return result;
+        }
+
+    public:
+        GameStore() : m_games(), m_chunks(), m_keyChunks(), m_size(0), m_board(), m_history(), m_legal() {}
+
+        // Room for this many games and plies in all without a further allocation, so long as few games are deep
+        // into a long run of reversible moves at once.
+        void reserve(std::size_t games, std::size_t plies)
+        {
+            m_games.reserve(games);
+            m_chunks.reserve(plies / s_chunkMoves + games);
+            m_keyChunks.reserve(games);
+        }
+
+        // A new game from a position; whatever led to it is not kept.
+        std::uint64_t create(const chess::Board &start)
+        {
+            const auto index = m_games.allocate();
+            auto &game = m_games[index];
+            game.generation++;
+            game.current = start.state();
+            game.start = PackedPosition::pack(start, 0, 1);
+            game.plies = 0;
+            game.first = game.last = s_none;
+            game.keys = s_none;
+            game.keyCount = 0;
+            game.result = chess::Result::LegalMove;
+            m_size++;
+            return std::uint64_t(game.generation) << 32 | index;
+        }
+
+        bool erase(std::uint64_t id)
+        {
+            const auto index = slot(id);
+            if (index == s_none) return false;
+
+            auto &game = m_games[index];
+            for (auto chunk = game.first; chunk != s_none; chunk = m_chunks[chunk].next)
+                m_chunks.release(chunk);
+            releaseKeys(game);
+            game.generation++;
+            m_games.release(index);
+            m_size--;
+            return true;
+        }
+
+        [[nodiscard]] bool contains(std::uint64_t id) const noexcept { return slot(id) != s_none; }
+
+        // Unknown ids, finished games and illegal moves are all IllegalMove, and leave the store as it was.
+        chess::Result play(std::uint64_t id, chess::Move move)
+        {
+            const auto index = slot(id);
+            if (index == s_none || m_games[index].result != chess::Result::LegalMove) return chess::Result::IllegalMove;
+            load(m_games[index]);
+            return play(m_games[index], move);
+        }
+
+        chess::Result play(std::uint64_t id, std::string_view uciMove)
+        {
+            const auto index = slot(id);
+            if (index == s_none || m_games[index].result != chess::Result::LegalMove) return chess::Result::IllegalMove;
+            load(m_games[index]);
+            return play(m_games[index], m_board.parse(uciMove));
+        }
+
+        // Whether a move could be played now, for premoves and move hints; false for unknown or finished games.
+        [[nodiscard]] bool isLegal(std::uint64_t id, chess::Move move)
+        {
+            const auto index = slot(id);
+            if (index == s_none || m_games[index].result != chess::Result::LegalMove) return false;
+            m_board.set(m_games[index].current);
+            return m_legal.isLegal(m_board, move);
+        }
+
+        // LegalMove while the game is in play.
+        [[nodiscard]] chess::Result result(std::uint64_t id) const { return game(id).result; }
+
+        [[nodiscard]] std::uint32_t plies(std::uint64_t id) const { return game(id).plies; }
+
+        // The current position in the binary training format, its result set once the game is over.
+        [[nodiscard]] PackedPosition snapshot(std::uint64_t id) const
+        {
+            const auto &record = game(id);
+            chess::Board board;
+            board.set(record.current);
+            return PackedPosition::pack(board, 0, outcome(record.result));
+        }
+
+        // The current position with the history a search needs to see repetitions.
+        [[nodiscard]] chess::Board board(std::uint64_t id)
+        {
+            load(game(id));
+            return m_board;
+        }
+
+        [[nodiscard]] std::vector<chess::Move> moves(std::uint64_t id) const
+        {
+            const auto &record = game(id);
+            std::vector<chess::Move> moves;
+            moves.reserve(record.plies);
+            forEachMove(record, [&moves](chess::Move move) { moves.push_back(move); });
+            return moves;
+        }
+
+        // Appends the whole game: the starting PackedPosition, the ply count as 4 bytes and the moves at 2 bytes
+        // each, all in host byte order like the training data.
+        void save(std::uint64_t id, std::vector<std::uint8_t> &out) const
+        {
+            const auto &record = game(id);
+            auto append = [&out](const void *data, std::size_t size)
+            {
+                const auto offset = out.size();
+                out.resize(offset + size);
+                std::memcpy(out.data() + offset, data, size);
+            };
+            append(&record.start, sizeof(record.start));
+            append(&record.plies, sizeof(record.plies));
+            forEachMove(record, [&append](chess::Move move)
+            {
+                const auto data = move.data();
+                append(&data, sizeof(data));
+            });
+        }
+
+        // A game written by save, played again move by move so a corrupt record cannot get in. consumed is set to
+        // the record's length, for reading a sequence of them. The scratch board keeps its history throughout, so
+        // the whole game is played once.
+        std::uint64_t restore(std::span<const std::uint8_t> bytes, std::size_t &consumed)
+        {
+            PackedPosition start;
+            std::uint32_t plies;
+            if (bytes.size() < sizeof(start) + sizeof(plies)) throw std::runtime_error("truncated game record");
+            std::memcpy(&start, bytes.data(), sizeof(start));
+            std::memcpy(&plies, bytes.data() + sizeof(start), sizeof(plies));
+            consumed = sizeof(start) + sizeof(plies) + std::size_t(plies) * sizeof(std::uint16_t);
+            if (bytes.size() < consumed) throw std::runtime_error("truncated game record");
+
+            start.unpack(m_board);
+            const auto id = create(m_board);
+            auto &record = m_games[slot(id)];
+            for (std::uint32_t i = 0; i < plies; i++)
+            {
+                std::uint16_t data;
+                std::memcpy(&data, bytes.data() + sizeof(start) + sizeof(plies) + i * sizeof(data), sizeof(data));
+                if (record.result != chess::Result::LegalMove || play(record, chess::Move::fromData(data)) == chess::Result::IllegalMove)
+                {
+                    erase(id);
+                    throw std::runtime_error("illegal move in game record");
+                }
+            }
+            return id;
+        }
+
+        [[nodiscard]] std::size_t size() const noexcept { return m_size; }
+
+        // Everything the slabs hold, live or free.
+        [[nodiscard]] std::size_t bytes() const noexcept { return m_games.bytes() + m_chunks.bytes() + m_keyChunks.bytes(); }
+    };
+} // namespace engine
+
+#endif // CHESS_ENGINE_GAME_STORE_H
@@ -0,0 +1,229 @@
+#ifndef CHESS_ENGINE_MATCH_H
+#define CHESS_ENGINE_MATCH_H
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "Score.h"
+#include "Search.h"
+#include "TranspositionTable.h"
+#include "chess/Board.hpp"
+#include "chess/Move.h"
+#include "chess/Result.h"
+
+namespace engine
+{
+    // Per-game clock of base + increment, or a fixed node or depth budget per move when those are set.
+    struct TimeControl
+    {
+        std::chrono::milliseconds base{10000};
+        std::chrono::milliseconds increment{100};
+        std::uint64_t nodes = 0;
+        int depth = 0;
+
+        // "seconds+increment", e.g. "10+0.1".
+        static TimeControl parse(std::string_view text)
+        {
+            TimeControl tc;
+            const auto plus = text.find('+');
+            tc.base = std::chrono::milliseconds(std::llround(std::stod(std::string(text.substr(0, plus))) * 1000));
+            tc.increment = std::chrono::milliseconds(plus == std::string_view::npos ? 0 : std::llround(std::stod(std::string(text.substr(plus + 1))) * 1000));
+            return tc;
+        }
+
+        [[nodiscard]] bool clocked() const noexcept { return nodes == 0 && depth == 0; }
+    };
+
+    struct PlayerConfig
+    {
+        std::string name;
+        Options options{};
+        std::size_t hash = 8;
+    };
+
+    // Games are cut short once both sides agree on the outcome for long enough.
+    struct Adjudication
+    {
+        score_t resignScore = 1000;
+        int resignPlies = 8;
+        score_t drawScore = 10;
+        int drawPlies = 16;
+        int drawFromMove = 40;
+        int maxPlies = 400;
+    };
+
+    enum class Termination : unsigned char
+    {
+        Checkmate, Stalemate, InsufficientMaterial, FiftyMoveRule, Repetition, Time, ResignAdjudication, DrawAdjudication, MaxLength, Aborted
+    };
+
+    constexpr std::string_view terminationName(Termination termination) noexcept
+    {
+        constexpr std::string_view names[]{"checkmate", "stalemate", "insufficient material", "fifty-move rule", "repetition", "time forfeit",
+                                           "resign adjudication", "draw adjudication", "max length", "aborted"};
+        return names[std::to_underlying(termination)];
+    }
+
+    struct GameRecord
+    {
+        std::string startFen{};
+        std::vector<chess::Move> moves{};
+        std::vector<score_t> scores{}; // Each mover's own evaluation, from its side.
+        chess::Result result = chess::Result::Draw;
+        Termination termination = Termination::Aborted;
+    };
+
+    // Opening positions, one EPD per line; only the four position fields are used.
+    inline std::vector<std::string> loadOpenings(const std::string &path)
+    {
+        std::ifstream in(path);
+        if (!in) throw std::runtime_error("cannot open " + path);
+
+        std::vector<std::string> fens;
+        std::string line;
+        while (std::getline(in, line))
+        {
+            std::istringstream fields(line);
+            std::string placement, turn, castling, enPassant;
+            if (fields >> placement >> turn >> castling >> enPassant)
+                fens.push_back(placement + ' ' + turn + ' ' + castling + ' ' + enPassant + " 0 1");
+        }
+        return fens;
+    }
+
+    // A search with its own table, so games running in parallel share nothing.
+    class Player
+    {
+        TranspositionTable m_table;
+        Search m_search;
+
+    public:
+        explicit Player(const PlayerConfig &config) : m_table(config.hash), m_search(m_table) { m_search.setOptions(config.options); }
+
+        Info think(const chess::Board &board, const Limits &limits) { return m_search.run(board, limits, 1); }
+
+        void stop() noexcept { m_search.stop(); }
+    };
+
+    // Records how the game ended if the position is over, the side to move being the one mated.
+    inline bool over(const chess::Board &board, GameRecord &game) noexcept
+    {
+        switch (board.status())
+        {
+            case chess::Status::Checkmate:
+                game.result = board.turn() == chess::Color::White ? chess::Result::BlackWin : chess::Result::WhiteWin;
+                game.termination = Termination::Checkmate;
+                return true;
+            case chess::Status::Stalemate:
+                game.termination = Termination::Stalemate;
+                return true;
+            case chess::Status::InsufficientMaterial:
+                game.termination = Termination::InsufficientMaterial;
+                return true;
+            case chess::Status::FiftyMoveRule:
+                game.termination = Termination::FiftyMoveRule;
+                return true;
+            case chess::Status::Repetition:
+                game.termination = Termination::Repetition;
+                return true;
+            case chess::Status::Ongoing:
+            default:
+                return false;
+        }
+    }
+
+    // Plays one game with one search thread per side. Checking abort between moves lets a finished match end early.
+    inline GameRecord playGame(const std::string &startFen, const PlayerConfig &white, const PlayerConfig &black, const TimeControl &tc,
+                               const Adjudication &adjudication, const std::atomic<bool> &abort)
+    {
+        GameRecord game;
+        game.startFen = startFen;
+
+        chess::Board board(startFen);
+        if (over(board, game)) return game; // An opening that is already decided, with no move to play.
+
+        Player players[2]{Player(white), Player(black)};
+        std::chrono::milliseconds clocks[2]{tc.base, tc.base};
+        int resignStreak = 0, drawStreak = 0;
+
+        while (!abort.load(std::memory_order_relaxed))
+        {
+            const auto side = board.turn() == chess::Color::White ? 0 : 1;
+            const auto moverLoses = side == 0 ? chess::Result::BlackWin : chess::Result::WhiteWin;
+
+            Limits limits;
+            if (tc.nodes) limits.nodes = tc.nodes;
+            if (tc.depth) limits.depth = tc.depth;
+            if (tc.clocked()) limits.time = Limits::forClock(clocks[side], tc.increment);
+
+            const auto start = std::chrono::steady_clock::now();
+            const auto info = players[side].think(board, limits);
+            if (tc.clocked())
+            {
+                clocks[side] -= std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+                if (clocks[side].count() < 0)
+                {
+                    game.result = moverLoses;
+                    game.termination = Termination::Time;
+                    return game;
+                }
+                clocks[side] += tc.increment;
+            }
+
+            auto move = info.pv.empty() ? chess::Move() : info.pv.front();
+            chess::Board::Undo undo;
+            if (move.isNull() || !board.make(move, undo))
+            {
+                // Stopped before the first iteration finished: any legal move will do.
+                chess::MoveList moves;
+                board.generate(moves);
+                for (const auto candidate: moves)
+                    if (board.make(candidate, undo))
+                    {
+                        move = candidate;
+                        break;
+                    }
+            }
+            game.moves.push_back(move);
+            game.scores.push_back(info.score);
+
+            if (over(board, game)) return game;
+
+            // Both sides must agree, so a streak counts plies from alternating points of view.
+            const auto whiteScore = side == 0 ? info.score : -info.score;
+            resignStreak = std::abs(whiteScore) >= adjudication.resignScore && (resignStreak == 0 || (whiteScore > 0) == (resignStreak > 0))
+                           ? resignStreak + (whiteScore > 0 ? 1 : -1) : 0;
+            if (std::abs(resignStreak) >= adjudication.resignPlies)
+            {
+                game.result = resignStreak > 0 ? chess::Result::WhiteWin : chess::Result::BlackWin;
+                game.termination = Termination::ResignAdjudication;
+                return game;
+            }
+
+            drawStreak = board.fullMoveNumber() >= adjudication.drawFromMove && std::abs(info.score) <= adjudication.drawScore ? drawStreak + 1 : 0;
+            if (drawStreak >= adjudication.drawPlies)
+            {
+                game.termination = Termination::DrawAdjudication;
+                return game;
+            }
+
+            if (static_cast<int>(game.moves.size()) >= adjudication.maxPlies)
+            {
+                game.termination = Termination::MaxLength;
+                return game;
+            }
+        }
+        return game;
+    }
+} // namespace engine
+
+#endif // CHESS_ENGINE_MATCH_H
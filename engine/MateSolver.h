@@ -0,0 +1,176 @@
+#ifndef CHESS_ENGINE_MATE_SOLVER_H
+#define CHESS_ENGINE_MATE_SOLVER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "chess/Board.hpp"
+#include "chess/Move.h"
+#include "chess/Zobrist.h"
+#include "search/ProofNumber.h"
+#include "search/Solution.h"
+
+namespace engine
+{
+    // Forced mate by the side to move at the root, as a search::ProofProblem. With checksOnly the attacker may only
+    // give check, which keeps the tree narrow enough for proof numbers to beat alpha-beta by orders of magnitude but
+    // misses mates with a quiet move in them, so only its proofs are final; without it every legal move is tried.
+    // The defender always tries every legal move. Draws by repetition or the fifty-move rule and stalemates are
+    // failures for the attacker.
+    class MateProblem
+    {
+        chess::Board::State m_root;
+        std::vector<chess::zobrist_t> m_history; // The root's, for repetitions that reach back past it.
+        chess::Board m_scratch;                   // Set from a node to generate or play its moves.
+        chess::Color m_attacker;
+        bool m_checksOnly;
+
+    public:
+        // A position and the node it was reached from, nullptr at the root. DfPn keeps each node in place while its
+        // ply is searched, so the parents are the path, and a repetition is found by walking back up them: a node is
+        // the size of a State and nothing on the heap.
+        struct Node
+        {
+            chess::Board::State position{};
+            const Node *parent = nullptr;
+        };
+
+        using state_type = Node;
+        using action_type = chess::Move;
+
+        explicit MateProblem(const chess::Board &root, bool checksOnly = true)
+                : m_root(root.state()), m_history(root.history().begin(), root.history().end()), m_scratch(), m_attacker(root.turn()),
+                  m_checksOnly(checksOnly) {}
+
+        void setRoot(const chess::Board &root)
+        {
+            m_root = root.state();
+            m_history.assign(root.history().begin(), root.history().end());
+            m_attacker = root.turn();
+        }
+
+        void setChecksOnly(bool checksOnly) noexcept { m_checksOnly = checksOnly; }
+
+        [[nodiscard]] Node initialState() const noexcept { return {m_root, nullptr}; }
+
+        // As Board::isRepetition: an earlier position with the same key an even number of plies back, at least four,
+        // and since the last capture or pawn move.
+        [[nodiscard]] bool isRepetition(const Node &node) const noexcept
+        {
+            const int clock = node.position.halfMoveClock;
+            const auto key = node.position.key;
+            int back = 1;
+            for (auto earlier = node.parent; earlier && back <= clock; earlier = earlier->parent, back++)
+                if (back >= 4 && back % 2 == 0 && earlier->position.key == key) return true;
+            for (auto i = m_history.size(); i-- > 0 && back <= clock; back++)
+                if (back >= 4 && back % 2 == 0 && m_history[i] == key) return true;
+            return false;
+        }
+
+        [[nodiscard]] search::Proof evaluate(const Node &node) noexcept
+        {
+            if (isRepetition(node) || node.position.halfMoveClock >= 100) return search::Proof::Disproven;
+            m_scratch.set(node.position);
+            if (m_scratch.countLegalMoves() > 0) return search::Proof::Unknown;
+            return m_scratch.inCheck() && node.position.turn != m_attacker ? search::Proof::Proven : search::Proof::Disproven;
+        }
+
+        void actions(const Node &node, search::action_sink_t<chess::Move> out)
+        {
+            const bool filtered = m_checksOnly && node.position.turn == m_attacker;
+            m_scratch.set(node.position);
+            chess::MoveList moves;
+            m_scratch.generate(moves);
+            for (const auto move: moves)
+            {
+                chess::Board::Undo undo;
+                if (!m_scratch.make(move, undo)) continue;
+                const bool check = m_scratch.inCheck();
+                m_scratch.unmake(move, undo);
+                if (check || !filtered) *out++ = move;
+            }
+        }
+
+        void successor(const Node &node, chess::Move move, Node &out)
+        {
+            m_scratch.set(node.position);
+            chess::Board::Undo undo;
+            (void) m_scratch.make(move, undo);
+            out.position = m_scratch.state();
+            out.parent = &node;
+        }
+
+        // Which side attacks and whether it may only check are part of the key, so table entries hold for any root
+        // in either mode and the table can be kept from one problem to the next.
+        [[nodiscard]] std::uint64_t key(const Node &node) const noexcept
+        {
+            const auto key = m_attacker == chess::Color::White ? node.position.key : node.position.key ^ 0xD6E8FEB86659FD93;
+            return m_checksOnly ? key ^ 0x2545F4914F6CDD1D : key;
+        }
+    };
+
+    struct MateResult
+    {
+        search::Proof proof = search::Proof::Unknown; // Proven with a mate, Disproven when there is none within reach.
+        int moves = 0;                                // Attacker moves to mate, when proven.
+        std::vector<chess::Move> line{};
+        search::Statistics statistics{};              // Summed over every depth tried.
+    };
+
+    // Proves the shortest forced mate of at most maxMoves attacker moves, trying mate in 1, 2, ... in turn. With
+    // checksFirst each length is searched with checks only and, if that proves nothing, again with every move, so
+    // the cheap search finds most mates and a quiet one is still never reported as none. The proof table is kept
+    // between positions, which suits a batch of puzzles: nothing is allocated per position once the deepest ply has
+    // been reached. nodeLimit bounds the expansions of each search; running out leaves the result Unknown.
+    class MateSolver
+    {
+        MateProblem m_problem;
+        search::DfPn<MateProblem> m_solver;
+        bool m_checksFirst;
+
+        search::ProofSolution<chess::Move> search(int depth, bool checksOnly, MateResult &result)
+        {
+            m_problem.setChecksOnly(checksOnly);
+            const auto solution = m_solver.search(depth);
+            result.statistics.expanded += solution.statistics.expanded;
+            result.statistics.generated += solution.statistics.generated;
+            result.statistics.peakMemory = solution.statistics.peakMemory;
+            result.statistics.seconds += solution.statistics.seconds;
+            return solution;
+        }
+
+    public:
+        explicit MateSolver(std::size_t megabytes = 16, bool checksFirst = true, std::uint64_t nodeLimit = 0)
+                : m_problem(chess::Board(), checksFirst), m_solver(m_problem, megabytes, nodeLimit), m_checksFirst(checksFirst) {}
+
+        MateSolver(const MateSolver &) = delete;
+
+        MateSolver &operator=(const MateSolver &) = delete;
+
+        MateResult solve(const chess::Board &board, int maxMoves)
+        {
+            m_problem.setRoot(board);
+
+            MateResult result;
+            result.proof = search::Proof::Disproven;
+            for (int moves = 1; moves <= maxMoves; moves++)
+            {
+                auto solution = search(2 * moves - 1, m_checksFirst, result);
+                if (m_checksFirst && solution.proof != search::Proof::Proven) solution = search(2 * moves - 1, false, result);
+                if (solution.proof == search::Proof::Disproven) continue;
+
+                result.proof = solution.proof;
+                if (solution.proof == search::Proof::Proven)
+                {
+                    result.moves = moves;
+                    result.line = solution.path;
+                }
+                break;
+            }
+            return result;
+        }
+    };
+} // namespace engine
+
+#endif // CHESS_ENGINE_MATE_SOLVER_H
@@ -0,0 +1,122 @@
+#ifndef CHESS_ENGINE_NUMA_H
+#define CHESS_ENGINE_NUMA_H
+
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace engine
+{
+    // The CPUs of each NUMA node as Linux lists them under /sys, less any the process may not run on, so taskset and
+    // cgroup limits are respected. Anywhere else, or without that tree, one node holds every CPU.
+    class Topology
+    {
+        std::vector<std::vector<int>> m_nodes;
+
+        // A kernel CPU list such as "0-3,8-11".
+        [[nodiscard]] static std::vector<int> parseList(const std::string &list)
+        {
+            std::vector<int> cpus;
+            std::istringstream in(list);
+            std::string range;
+            while (std::getline(in, range, ','))
+            {
+                if (range.empty() || range == "\n") continue;
+                const auto dash = range.find('-');
+                const int first = std::stoi(range);
+                const int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+                for (int cpu = first; cpu <= last; cpu++)
+                    cpus.push_back(cpu);
+            }
+            return cpus;
+        }
+
+        [[nodiscard]] static std::vector<int> allowed()
+        {
+            std::vector<int> cpus;
+#ifdef __linux__
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            if (sched_getaffinity(0, sizeof(set), &set) == 0)
+                for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+                    if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+#endif
+            if (cpus.empty())
+                for (int cpu = 0; cpu < static_cast<int>(std::max(1u, std::thread::hardware_concurrency())); cpu++)
+                    cpus.push_back(cpu);
+            return cpus;
+        }
+
+    public:
+        Topology() : m_nodes()
+        {
+            const auto usable = allowed();
+            std::error_code error;
+            for (const auto &entry: std::filesystem::directory_iterator("/sys/devices/system/node", error))
+            {
+                const auto name = entry.path().filename().string();
+                if (name.size() < 5 || name.compare(0, 4, "node") != 0 || name.find_first_not_of("0123456789", 4) != std::string::npos) continue;
+
+                std::ifstream in(entry.path() / "cpulist");
+                std::string list;
+                std::getline(in, list);
+                auto cpus = parseList(list);
+                std::erase_if(cpus, [&](int cpu) { return !std::ranges::binary_search(usable, cpu); });
+                if (!cpus.empty()) m_nodes.push_back(std::move(cpus)); // Memory-only nodes have no CPUs.
+            }
+            if (m_nodes.empty()) m_nodes.push_back(usable);
+            std::ranges::sort(m_nodes, [](const auto &a, const auto &b) noexcept { return a.front() < b.front(); });
+        }
+
+        // Read once, by the first caller: pinned threads see only their own CPU.
+        [[nodiscard]] static const Topology &system()
+        {
+            static const Topology topology;
+            return topology;
+        }
+
+        [[nodiscard]] std::size_t nodes() const noexcept { return m_nodes.size(); }
+
+        [[nodiscard]] std::size_t cpus() const noexcept
+        {
+            std::size_t count = 0;
+            for (const auto &node: m_nodes)
+                count += node.size();
+            return count;
+        }
+
+        // Threads go round the nodes first, so n threads use every node before any node gets a second one, then through
+        // each node's CPUs in order.
+        [[nodiscard]] int cpu(unsigned thread) const noexcept
+        {
+            const auto &node = m_nodes[thread % m_nodes.size()];
+            return node[(thread / m_nodes.size()) % node.size()];
+        }
+
+        // Binds the calling thread to cpu(thread). False where that is not supported or not allowed.
+        bool pin(unsigned thread) const noexcept
+        {
+#ifdef __linux__
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu(thread), &set);
+            return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+            (void) thread;
+            return false;
+#endif
+        }
+    };
+} // namespace engine
+
+#endif // CHESS_ENGINE_NUMA_H
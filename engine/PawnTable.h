@@ -0,0 +1,155 @@
+#ifndef CHESS_ENGINE_PAWN_TABLE_H
+#define CHESS_ENGINE_PAWN_TABLE_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <vector>
+
+#include "Score.h"
+#include "chess/Board.hpp"
+
+namespace engine
+{
+    // Everything the evaluation wants that depends on the pawns alone. Scores are from White's side, the arrays
+    // are indexed by colour, White first.
+    struct alignas(64) PawnEntry
+    {
+        chess::zobrist_t key = 0;
+        score_t middlegame = 0;
+        score_t endgame = 0;
+        std::array<chess::Board::bitboard_t, 2> passed{};
+        std::array<chess::Board::bitboard_t, 2> attacks{};
+        std::array<chess::Board::bitboard_t, 2> attackSpans{}; // Every square the pawns could attack by advancing.
+    };
+
+    namespace Pawns
+    {
+        using bitboard_t = chess::Board::bitboard_t;
+
+        // Bit index = rank * 8 + (7 - file), so the a-file is the top bit of each rank.
+        constexpr const bitboard_t FileA = 0x8080808080808080;
+        constexpr const bitboard_t FileH = 0x0101010101010101;
+
+        // By relative rank, from the pawn's own side.
+        constexpr const std::array<score_t, 8> PassedMiddlegame{0, 5, 10, 15, 25, 40, 60, 0};
+        constexpr const std::array<score_t, 8> PassedEndgame{0, 10, 15, 25, 45, 70, 110, 0};
+
+        constexpr const score_t DoubledMiddlegame = -10, DoubledEndgame = -20;
+        constexpr const score_t IsolatedMiddlegame = -10, IsolatedEndgame = -15;
+        constexpr const score_t BackwardMiddlegame = -8, BackwardEndgame = -10;
+
+        template<chess::Color C>
+        [[nodiscard]] constexpr bitboard_t forward(bitboard_t b) noexcept { return C == chess::Color::White ? b << 8 : b >> 8; }
+
+        // b and every square in front of it.
+        template<chess::Color C>
+        [[nodiscard]] constexpr bitboard_t fill(bitboard_t b) noexcept
+        {
+            if constexpr (C == chess::Color::White)
+            {
+                b |= b << 8;
+                b |= b << 16;
+                return b | b << 32;
+            }
+            else
+            {
+                b |= b >> 8;
+                b |= b >> 16;
+                return b | b >> 32;
+            }
+        }
+
+        [[nodiscard]] constexpr bitboard_t sideways(bitboard_t b) noexcept { return ((b & ~FileA) << 1) | ((b & ~FileH) >> 1); }
+
+        template<chess::Color C>
+        [[nodiscard]] constexpr bitboard_t attacks(bitboard_t pawns) noexcept { return sideways(forward<C>(pawns)); }
+
+        template<chess::Color C>
+        constexpr void structure(const chess::Board &board, PawnEntry &entry) noexcept
+        {
+            constexpr auto Them = chess::Colored::Opposite<C>;
+            constexpr int side = C == chess::Color::Black;
+            const auto own = board.pieces(chess::Colored::Pawn<C>);
+            const auto enemy = board.pieces(chess::Colored::Pawn<Them>);
+            const auto enemyAttacks = attacks<Them>(enemy);
+
+            score_t middlegame = 0;
+            score_t endgame = 0;
+            for (auto pawns = own; pawns; pawns &= pawns - 1)
+            {
+                const auto sq = __builtin_ctzll(pawns);
+                const auto pawn = bitboard_t(1) << sq;
+                const auto front = fill<C>(forward<C>(pawn));
+                const auto file = fill<C>(pawn) | fill<Them>(pawn);
+
+                // The rear pawn of a doubled pair is not passed, the front one is.
+                if (((front | sideways(front)) & enemy) == 0 && (front & own) == 0)
+                {
+                    const auto rank = C == chess::Color::White ? sq >> 3 : 7 - (sq >> 3);
+                    entry.passed[side] |= pawn;
+                    middlegame += PassedMiddlegame[rank];
+                    endgame += PassedEndgame[rank];
+                }
+                if (front & own)
+                {
+                    middlegame += DoubledMiddlegame;
+                    endgame += DoubledEndgame;
+                }
+
+                // Backward: every neighbour is already ahead of it and the square in front is held by an enemy pawn.
+                const auto neighbours = own & sideways(file);
+                if (neighbours == 0)
+                {
+                    middlegame += IsolatedMiddlegame;
+                    endgame += IsolatedEndgame;
+                }
+                else if ((neighbours & ~sideways(front)) == 0 && (forward<C>(pawn) & enemyAttacks))
+                {
+                    middlegame += BackwardMiddlegame;
+                    endgame += BackwardEndgame;
+                }
+            }
+
+            entry.attacks[side] = attacks<C>(own);
+            entry.attackSpans[side] = fill<C>(entry.attacks[side]);
+            entry.middlegame += C == chess::Color::White ? middlegame : -middlegame;
+            entry.endgame += C == chess::Color::White ? endgame : -endgame;
+        }
+
+        [[nodiscard]] constexpr PawnEntry analyse(const chess::Board &board) noexcept
+        {
+            PawnEntry entry;
+            entry.key = board.pawnKey();
+            structure<chess::Color::White>(board, entry);
+            structure<chess::Color::Black>(board, entry);
+            return entry;
+        }
+    }
+
+    // Per thread, so it is written without synchronisation. Pawn structures repeat across most of the tree, so nearly
+    // every probe hits. An untouched slot has key 0, which is also the key of the pawnless structure, and reads as
+    // its entry: all zeros.
+    class PawnTable
+    {
+        std::vector<PawnEntry> m_entries;
+
+    public:
+        static constexpr const std::size_t DefaultEntries = 1 << 14; // 1 MB
+
+        explicit PawnTable(std::size_t entries = DefaultEntries) : m_entries(std::bit_floor(std::max<std::size_t>(entries, 1))) {}
+
+        [[nodiscard]] const PawnEntry &probe(const chess::Board &board, bool &hit) noexcept
+        {
+            auto &entry = m_entries[board.pawnKey() & (m_entries.size() - 1)];
+            hit = entry.key == board.pawnKey();
+            if (!hit) entry = Pawns::analyse(board);
+            return entry;
+        }
+
+        void clear() noexcept { std::fill(m_entries.begin(), m_entries.end(), PawnEntry()); }
+    };
+} // namespace engine
+
+#endif // CHESS_ENGINE_PAWN_TABLE_H
@@ -0,0 +1,194 @@
+#ifndef CHESS_ENGINE_PERFT_H
+#define CHESS_ENGINE_PERFT_H
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "chess/Board.hpp"
+
+namespace engine
+{
+    // Subtree counts by (key, depth), shared by every perft thread without locks. Same slot layout as the
+    // TranspositionTable: a torn slot fails the check and reads as a miss.
+    class PerftTable
+    {
+        struct Slot
+        {
+            std::atomic<std::uint64_t> check{0};
+            std::atomic<std::uint64_t> data{0};
+        };
+
+        std::unique_ptr<Slot[]> m_slots;
+        std::size_t m_mask;
+
+        // The same position recurs at several depths, so the depth is mixed into the slot as well as stored.
+        [[nodiscard]] std::size_t index(chess::zobrist_t key, int depth) const noexcept
+        {
+            return (key ^ (std::uint64_t(depth) * 0x9E3779B97F4A7C15)) & m_mask;
+        }
+
+    public:
+        explicit PerftTable(std::size_t megabytes = 16) : m_slots(), m_mask(0)
+        {
+            const auto count = std::bit_floor(std::max<std::size_t>(1, megabytes * 1024 * 1024 / sizeof(Slot)));
+            m_slots = std::make_unique<Slot[]>(count);
+            m_mask = count - 1;
+        }
+
+        // count (56) | depth (8)
+        [[nodiscard]] bool probe(chess::zobrist_t key, int depth, std::uint64_t &count) const noexcept
+        {
+            const auto &entry = m_slots[index(key, depth)];
+            const auto data = entry.data.load(std::memory_order_relaxed);
+            if ((entry.check.load(std::memory_order_relaxed) ^ data) != key || int(data & 0xFF) != depth) return false;
+
+            count = data >> 8;
+            return true;
+        }
+
+        void store(chess::zobrist_t key, int depth, std::uint64_t count) noexcept
+        {
+            auto &entry = m_slots[index(key, depth)];
+            const auto data = (count << 8) | std::uint64_t(depth);
+            entry.check.store(key ^ data, std::memory_order_relaxed);
+            entry.data.store(data, std::memory_order_relaxed);
+        }
+    };
+
+    // Leaf nodes of the legal move tree. The last ply is counted, not played.
+    template<chess::Color C>
+    [[nodiscard]] std::uint64_t perft(chess::Board &board, int depth, PerftTable &table)
+    {
+        if (depth <= 0) return 1;
+        if (depth == 1) return board.countLegalMoves<C>();
+
+        std::uint64_t nodes = 0;
+        if (table.probe(board.key(), depth, nodes)) return nodes;
+
+        chess::MoveList moves;
+        board.generate<C>(moves);
+        for (const auto move: moves)
+        {
+            chess::Board::Undo undo;
+            if (!board.make<C>(move, undo)) continue;
+            nodes += perft<chess::Colored::Opposite<C>>(board, depth - 1, table);
+            board.unmake<C>(move, undo);
+        }
+        table.store(board.key(), depth, nodes);
+        return nodes;
+    }
+
+    [[nodiscard]] inline std::uint64_t perft(chess::Board &board, int depth, PerftTable &table)
+    {
+        return board.turn() == chess::Color::White ? perft<chess::Color::White>(board, depth, table)
+                                                   : perft<chess::Color::Black>(board, depth, table);
+    }
+
+    struct PerftResult
+    {
+        std::uint64_t nodes = 0;
+        double seconds = 0.0;
+        std::vector<std::pair<chess::Move, std::uint64_t>> divide{};
+
+        [[nodiscard]] double nodesPerSecond() const noexcept { return seconds > 0.0 ? double(nodes) / seconds : 0.0; }
+    };
+
+    // The work is split two plies deep, into one task per root move and reply, which gives a few hundred tasks for
+    // threads to take from a shared counter: root moves alone are too few and too uneven to balance. Transpositions
+    // between tasks are shared through the table.
+    inline PerftResult perft(const chess::Board &board, int depth, unsigned threads, std::size_t megabytes = 16)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        PerftTable table(megabytes);
+        PerftResult result;
+        if (depth <= 0)
+        {
+            result.nodes = 1;
+            return result;
+        }
+
+        // Perft has no use for the history, so a task holds only the position and each thread plays it on its own board.
+        struct Task
+        {
+            std::size_t root;
+            chess::Board::State position;
+            std::uint64_t nodes;
+        };
+        std::vector<Task> tasks;
+
+        auto position = board;
+        chess::MoveList moves;
+        position.generate(moves);
+        for (const auto move: moves)
+        {
+            chess::Board::Undo undo;
+            if (!position.make(move, undo)) continue;
+
+            const auto root = result.divide.size();
+            result.divide.emplace_back(move, 0);
+            if (depth < 3)
+                result.divide.back().second = perft(position, depth - 1, table);
+            else
+            {
+                chess::MoveList replies;
+                position.generate(replies);
+                for (const auto reply: replies)
+                {
+                    chess::Board::Undo replyUndo;
+                    if (!position.make(reply, replyUndo)) continue;
+                    tasks.push_back({root, position.state(), 0});
+                    position.unmake(reply, replyUndo);
+                }
+            }
+            position.unmake(move, undo);
+        }
+
+        std::atomic<std::size_t> next{0};
+        auto work = [&]
+        {
+            chess::Board scratch;
+            for (auto i = next.fetch_add(1, std::memory_order_relaxed); i < tasks.size(); i = next.fetch_add(1, std::memory_order_relaxed))
+            {
+                scratch.set(tasks[i].position);
+                tasks[i].nodes = perft(scratch, depth - 2, table);
+            }
+        };
+        {
+            std::vector<std::jthread> pool;
+            for (unsigned i = 1; i < std::max(1u, threads); i++)
+                pool.emplace_back(work);
+            work();
+        }
+
+        for (const auto &task: tasks)
+            result.divide[task.root].second += task.nodes;
+        for (const auto &[move, nodes]: result.divide)
+            result.nodes += nodes;
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return result;
+    }
+
+    inline PerftResult perft(const chess::Board &board, int depth, unsigned threads, std::size_t megabytes, std::ostream &out)
+    {
+        auto result = perft(board, depth, threads, megabytes);
+        for (const auto &[move, nodes]: result.divide)
+            out << move.uci() << ": " << nodes << '\n';
+
+        out << "===========================\n"
+            << "Total time (ms) : " << static_cast<std::uint64_t>(result.seconds * 1000) << '\n'
+            << "Nodes searched  : " << result.nodes << '\n'
+            << "Nodes/second    : " << static_cast<std::uint64_t>(result.nodesPerSecond()) << '\n';
+        return result;
+    }
+} // namespace engine
+
+#endif // CHESS_ENGINE_PERFT_H
@@ -0,0 +1,263 @@
+#ifndef CHESS_ENGINE_SCHEDULER_H
+#define CHESS_ENGINE_SCHEDULER_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Search.h"
+#include "TranspositionTable.h"
+#include "chess/Board.hpp"
+#include "chess/Zobrist.h"
+
+namespace engine
+{
+    // One search request. Higher priorities run first, equal ones in submission order. owner groups the jobs of a
+    // client so they can be cancelled together. The position is kept as a State and the keys a repetition can still
+    // match, not a whole Board with its game history, since jobs wait in the queue by the hundred.
+    struct Job
+    {
+        std::uint64_t id = 0;
+        std::uint64_t owner = 0;
+        int priority = 0;
+        chess::Board::State position{};
+        std::vector<chess::zobrist_t> history{}; // Oldest first, as Board::history().
+        Limits limits{};
+        Options options{};
+        std::function<void(const Info &)> onIteration{};
+        std::function<void(const Info &, bool cancelled)> onFinish{}; // Once per job that ran or was cancelled.
+    };
+
+    // Runs jobs from many clients on a fixed pool of single-threaded searches that all share one table. A job is
+    // one thread's worth of work: the pool is the parallelism, so light requests do not each pay for a Lazy SMP
+    // start-up.
+    //
+    // Under load, when more jobs wait than there are workers, a worker takes a batch of jobs of the top priority at
+    // once and runs them back to back on its warm search: one queue lock and one wake-up for the lot. A batch is
+    // never more than the worker's share of the queue, so it does not take work an idle worker could have started.
+    class Scheduler
+    {
+        static constexpr const std::size_t s_batchSize = 8;
+
+        struct Entry
+        {
+            Job job;
+            bool cancelled = false;
+            bool running = false;
+        };
+
+        struct Worker
+        {
+            Search search;
+            chess::Board board; // The running job's position.
+            Entry *current = nullptr;
+
+            explicit Worker(TranspositionTable &table) : search(table), board() {}
+
+            Worker(const Worker &) = delete;
+
+            Worker &operator=(const Worker &) = delete;
+        };
+
+        using entry_t = std::shared_ptr<Entry>;
+
+        struct Later
+        {
+            bool operator()(const entry_t &a, const entry_t &b) const noexcept
+            {
+                return a->job.priority != b->job.priority ? a->job.priority < b->job.priority : a->job.id > b->job.id;
+            }
+        };
+
+        TranspositionTable &m_table;
+        std::vector<std::unique_ptr<Worker>> m_workers;
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::priority_queue<entry_t, std::vector<entry_t>, Later> m_queue;
+        std::unordered_map<std::uint64_t, entry_t> m_entries; // Queued, batched or running; cancelled ones only while running.
+        std::atomic<std::uint64_t> m_nextId;
+        std::uint64_t m_completed;
+        bool m_quit;
+        std::vector<std::jthread> m_pool;
+
+        // Cancelled entries stay in the queue until a worker pops and drops them.
+        [[nodiscard]] std::vector<entry_t> takeBatch()
+        {
+            std::vector<entry_t> batch;
+            const auto limit = std::clamp<std::size_t>(m_queue.size() / m_workers.size(), 1, s_batchSize);
+            while (!m_queue.empty() && batch.size() < limit)
+            {
+                auto entry = m_queue.top();
+                if (!batch.empty() && entry->job.priority != batch.front()->job.priority) break;
+                m_queue.pop();
+                if (!entry->cancelled) batch.push_back(std::move(entry));
+            }
+            return batch;
+        }
+
+        void work(Worker &worker)
+        {
+            while (true)
+            {
+                std::vector<entry_t> batch;
+                {
+                    std::unique_lock lock(m_mutex);
+                    m_wake.wait(lock, [this] { return m_quit || !m_queue.empty(); });
+                    if (m_quit) return;
+                    batch = takeBatch();
+                }
+
+                for (const auto &entry: batch)
+                {
+                    // Started under the lock, so a cancel either finds the job not yet running or finds it on this worker.
+                    {
+                        const std::scoped_lock lock(m_mutex);
+                        if (entry->cancelled || m_quit) continue;
+                        entry->running = true;
+                        worker.current = entry.get();
+                        worker.search.setOptions(entry->job.options);
+                        worker.board.set(entry->job.position, entry->job.history);
+                        worker.search.start(worker.board, entry->job.limits, 1, entry->job.onIteration);
+                    }
+                    const auto info = worker.search.wait();
+
+                    bool cancelled;
+                    {
+                        const std::scoped_lock lock(m_mutex);
+                        worker.current = nullptr;
+                        m_entries.erase(entry->job.id);
+                        cancelled = entry->cancelled;
+                        m_completed++;
+                    }
+                    if (entry->job.onFinish) entry->job.onFinish(info, cancelled);
+                }
+            }
+        }
+
+        // A running job is stopped and finishes as usual with its best move so far; any other is reported here.
+        template<typename Match>
+        void cancelWhere(Match match)
+        {
+            std::vector<entry_t> dropped;
+            {
+                const std::scoped_lock lock(m_mutex);
+                for (auto it = m_entries.begin(); it != m_entries.end();)
+                {
+                    auto &entry = *it->second;
+                    if (!match(entry.job) || entry.cancelled)
+                    {
+                        ++it;
+                        continue;
+                    }
+
+                    entry.cancelled = true;
+                    if (entry.running)
+                    {
+                        for (const auto &worker: m_workers)
+                            if (worker->current == &entry) worker->search.stop();
+                        ++it;
+                        continue;
+                    }
+
+                    // Still in the queue or a batch, which check the flag and drop it.
+                    dropped.push_back(std::move(it->second));
+                    it = m_entries.erase(it);
+                }
+            }
+            for (const auto &entry: dropped)
+                if (entry->job.onFinish) entry->job.onFinish(Info(), true);
+        }
+
+    public:
+        explicit Scheduler(TranspositionTable &table, unsigned workers = std::max(1u, std::thread::hardware_concurrency()))
+                : m_table(table), m_workers(), m_mutex(), m_wake(), m_queue(), m_entries(), m_nextId(1), m_completed(0), m_quit(false), m_pool()
+        {
+            for (unsigned i = 0; i < std::max(1u, workers); i++)
+                m_workers.push_back(std::make_unique<Worker>(m_table));
+            for (auto &worker: m_workers)
+                m_pool.emplace_back([this, &worker = *worker] { work(worker); });
+        }
+
+        Scheduler(const Scheduler &) = delete;
+
+        Scheduler &operator=(const Scheduler &) = delete;
+
+        // Queued jobs are dropped without being reported.
+        ~Scheduler()
+        {
+            {
+                const std::scoped_lock lock(m_mutex);
+                m_quit = true;
+                for (const auto &worker: m_workers)
+                    worker->search.stop();
+            }
+            m_wake.notify_all();
+            m_pool.clear();
+        }
+
+        // An id for a job about to be submitted, for a caller that needs it before the job can start.
+        [[nodiscard]] std::uint64_t reserveId() noexcept { return m_nextId.fetch_add(1, std::memory_order_relaxed); }
+
+        // Queues the jobs under one lock and returns their ids in order. Jobs without an id are given one.
+        std::vector<std::uint64_t> submit(std::vector<Job> jobs)
+        {
+            std::vector<std::uint64_t> ids;
+            {
+                const std::scoped_lock lock(m_mutex);
+                for (auto &job: jobs)
+                {
+                    if (job.id == 0) job.id = reserveId();
+                    ids.push_back(job.id);
+                    auto entry = std::make_shared<Entry>(Entry{std::move(job), false, false});
+                    m_entries.emplace(ids.back(), entry);
+                    m_queue.push(std::move(entry));
+                }
+            }
+            if (ids.size() == 1) m_wake.notify_one();
+            else if (!ids.empty()) m_wake.notify_all();
+            return ids;
+        }
+
+        void cancel(std::uint64_t owner, std::uint64_t id)
+        {
+            cancelWhere([owner, id](const Job &job) { return job.owner == owner && job.id == id; });
+        }
+
+        void cancelOwner(std::uint64_t owner)
+        {
+            cancelWhere([owner](const Job &job) { return job.owner == owner; });
+        }
+
+        struct Status
+        {
+            std::size_t queued = 0;
+            std::size_t running = 0;
+            std::uint64_t completed = 0;
+        };
+
+        [[nodiscard]] Status status()
+        {
+            const std::scoped_lock lock(m_mutex);
+            Status status;
+            for (const auto &[id, entry]: m_entries)
+            {
+                if (entry->running) status.running++;
+                else status.queued++;
+            }
+            status.completed = m_completed;
+            return status;
+        }
+
+        [[nodiscard]] unsigned workers() const noexcept { return static_cast<unsigned>(m_workers.size()); }
+    };
+} // namespace engine
+
+#endif // CHESS_ENGINE_SCHEDULER_H
@@ -0,0 +1,21 @@
+#ifndef CHESS_ENGINE_SCORE_H
+#define CHESS_ENGINE_SCORE_H
+
+namespace engine
+{
+    // Centipawns from the side to move's point of view.
+    using score_t = int;
+
+    constexpr const int MaxPly = 128;
+
+    constexpr const score_t DrawScore = 0;
+    constexpr const score_t MateScore = 32000;
+    constexpr const score_t Infinity = MateScore + 1;
+
+    // Anything beyond this is a forced mate, scored MateScore minus the plies it takes.
+    constexpr const score_t MateBound = MateScore - MaxPly;
+
+    constexpr bool isMate(score_t score) noexcept { return score > MateBound || score < -MateBound; }
+} // namespace engine
+
+#endif // CHESS_ENGINE_SCORE_H
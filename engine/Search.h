@@ -0,0 +1,804 @@
+#ifndef CHESS_ENGINE_SEARCH_H
+#define CHESS_ENGINE_SEARCH_H
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <latch>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "Counters.h"
+#include "Evaluation.h"
+#include "Numa.h"
+#include "PawnTable.h"
+#include "Score.h"
+#include "Tracer.h"
+#include "TranspositionTable.h"
+#include "chess/Board.hpp"
+#include "chess/Move.h"
+
+namespace engine
+{
+    struct Limits
+    {
+        int depth = MaxPly - 1;
+        std::uint64_t nodes = 0;                     // 0 for no limit.
+        std::chrono::milliseconds time{0};           // 0 for no limit.
+        bool ponder = false;                         // The clock only starts at ponderhit().
+        bool infinite = false;                       // Hold bestmove until stop(), even once the depth limit is reached.
+
+        // A share of the remaining clock, never so much that the move arrives too late.
+        [[nodiscard]] static std::chrono::milliseconds forClock(std::chrono::milliseconds remaining, std::chrono::milliseconds increment,
+                                                               int movesToGo = 30) noexcept
+        {
+            const auto budget = remaining / std::max(1, movesToGo) + increment / 2;
+            return std::max(std::chrono::milliseconds(1), std::min(budget, remaining - std::chrono::milliseconds(50)));
+        }
+    };
+
+    // Search behaviour that can be changed between searches, by UCI or by a self-play configuration.
+    struct Options
+    {
+        score_t contempt = 0; // How much worse than equal a draw is for the side to move at the root.
+
+        // Selective search, each switchable to measure what it buys.
+        bool nullMove = true;
+        bool lateMoveReductions = true;
+        bool reverseFutility = true;
+        bool futility = true;
+        bool razoring = true;
+        bool checkExtensions = true;
+
+        int multiPv = 1; // Root moves to find a principal variation for, best first.
+
+        // Sets an option by its UCI name; false if the name or value is not understood.
+        bool set(std::string_view name, std::string_view value) noexcept
+        {
+            if (name == "Contempt") return std::from_chars(value.data(), value.data() + value.size(), contempt).ec == std::errc();
+            if (name == "MultiPV")
+            {
+                const auto parsed = std::from_chars(value.data(), value.data() + value.size(), multiPv).ec == std::errc();
+                multiPv = std::clamp(multiPv, 1, 256);
+                return parsed;
+            }
+
+            bool *flag = name == "NullMove" ? &nullMove : name == "LMR" ? &lateMoveReductions : name == "ReverseFutility" ? &reverseFutility
+                       : name == "Futility" ? &futility : name == "Razoring" ? &razoring : name == "CheckExtensions" ? &checkExtensions : nullptr;
+            if (flag == nullptr || (value != "true" && value != "false")) return false;
+            *flag = value == "true";
+            return true;
+        }
+    };
+
+    struct PvLine
+    {
+        score_t score = 0;
+        std::vector<chess::Move> pv{};
+    };
+
+    // One completed iteration of the main thread. score and pv are the best line; with MultiPV all lines found are
+    // in lines, best first.
+    struct Info
+    {
+        int depth = 0;
+        score_t score = 0;
+        std::uint64_t nodes = 0;
+        double seconds = 0.0;
+        std::vector<chess::Move> pv{};
+        std::vector<PvLine> lines{};
+    };
+
+    // Iterative deepening principal variation search with quiescence, a shared transposition table and Lazy SMP:
+    // helper threads search the same root on their own boards and only cooperate through the table.
+    //
+    // With one thread the search is deterministic for a fresh table and a depth limit, which is what bench relies on.
+    class Search
+    {
+        using clock_t = std::chrono::steady_clock;
+
+        struct Thread
+        {
+            chess::Board board;
+            unsigned id;
+            chess::Color rootTurn;
+            std::uint64_t nodes = 0;
+            Counters counters{};
+            TraceBuffer *trace = nullptr;
+            std::array<chess::Move, MaxPly> path{}; // path[ply] is the move that led to ply, for the tracer.
+            std::array<std::array<chess::Move, 2>, MaxPly> killers{};
+            std::array<std::array<std::array<int, 64>, 64>, 2> history{};
+            std::array<std::array<chess::Move, MaxPly>, MaxPly> pv{};
+            std::array<int, MaxPly> pvLength{};
+            std::vector<chess::Move> excluded{}; // Root moves already given a line this iteration.
+            PawnTable pawns{};
+
+            explicit Thread(unsigned threadId) : board(), id(threadId), rootTurn(chess::Color::White) {}
+
+            Thread(const Thread &) = delete;
+
+            Thread &operator=(const Thread &) = delete;
+        };
+
+        static constexpr const int s_ttMoveScore = 1 << 30;
+        static constexpr const int s_captureScore = 1 << 20;
+        static constexpr const int s_killerScore = 1 << 19;
+        static constexpr const int s_historyLimit = 1 << 16;
+        static constexpr const std::uint64_t s_checkInterval = 1024;
+
+        static constexpr const int s_reverseFutilityDepth = 6;
+        static constexpr const score_t s_reverseFutilityMargin = 80;
+        static constexpr const int s_razoringDepth = 2;
+        static constexpr const score_t s_razoringMargin = 300;
+        static constexpr const int s_nullMoveDepth = 3;
+        static constexpr const int s_futilityDepth = 3;
+        static constexpr const score_t s_futilityMargin = 120;
+        static constexpr const int s_lmrDepth = 3;
+        static constexpr const int s_lmrMoves = 3;
+
+        // Late move reductions by depth and move number: 0.75 + ln(depth) ln(moves) / 2.25.
+        static inline const auto s_reductions = []
+        {
+            std::array<std::array<int, 256>, MaxPly> table{};
+            for (int depth = 1; depth < MaxPly; depth++)
+                for (int moves = 1; moves < 256; moves++)
+                    table[depth][moves] = static_cast<int>(0.75 + std::log(depth) * std::log(moves) / 2.25);
+            return table;
+        }();
+
+        TranspositionTable &m_table;
+        std::atomic<bool> m_stop;
+        std::atomic<bool> m_pondering;
+        std::atomic<clock_t::rep> m_clockStart; // Moved by ponderhit(), so atomic unlike m_start.
+        Limits m_limits;
+        clock_t::time_point m_start;
+        SearchStatistics m_statistics;
+        Tracer *m_tracer;
+        Options m_options;
+
+        // Persistent threads, one per Thread, woken for each search. Thread 0 runs iterative deepening.
+        std::vector<std::unique_ptr<Thread>> m_threads;
+        std::vector<std::jthread> m_pool;
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::condition_variable m_done;
+        std::condition_variable m_release; // Signalled by stop() and ponderhit(), which can end a ponder or infinite search.
+        std::uint64_t m_generation;
+        unsigned m_running;
+        bool m_finished;
+        bool m_quit;
+        bool m_pinning;
+        bool m_pinned; // The threads in m_pool are bound to CPUs.
+        chess::Board m_root;
+        std::function<void(const Info &)> m_onIteration;
+        std::function<void(const Info &)> m_onFinish;
+        Info m_result;
+
+        [[nodiscard]] double elapsed() const noexcept { return std::chrono::duration<double>(clock_t::now() - m_start).count(); }
+
+        // Only the main thread polls the clock; helpers just watch the flag.
+        void checkLimits(const Thread &thread) noexcept
+        {
+            if (thread.id != 0 || thread.nodes % s_checkInterval != 0) return;
+            const auto clockStart = clock_t::time_point(clock_t::duration(m_clockStart.load(std::memory_order_relaxed)));
+            if ((m_limits.nodes && thread.nodes >= m_limits.nodes) ||
+                (m_limits.time.count() && !m_pondering.load(std::memory_order_relaxed) && clock_t::now() - clockStart >= m_limits.time))
+                m_stop.store(true, std::memory_order_relaxed);
+        }
+
+        template<chess::Color C>
+        [[nodiscard]] static int moveScore(const Thread &thread, chess::Move move, chess::Move ttMove, int ply) noexcept
+        {
+            if (move == ttMove) return s_ttMoveScore;
+
+            const auto &board = thread.board;
+            const auto captured = board.pieceAt(move.to());
+            if (captured != chess::Piece::None || move.promotion() != chess::Promotion::None)
+                return s_captureScore + Evaluation::value(captured) * 16 - (std::to_underlying(board.pieceAt(move.from())) & 7);
+
+            if (move == thread.killers[ply][0]) return s_killerScore + 1;
+            if (move == thread.killers[ply][1]) return s_killerScore;
+            return thread.history[C == chess::Color::Black][move.from()][move.to()];
+        }
+
+        template<chess::Color C>
+        static void scoreMoves(const Thread &thread, const chess::MoveList &moves, std::array<int, 256> &scores, chess::Move ttMove, int ply) noexcept
+        {
+            for (unsigned i = 0; i < moves.size(); i++)
+                scores[i] = moveScore<C>(thread, moves[i], ttMove, ply);
+        }
+
+        // Selection sort, one step per move tried: most nodes cut off after the first few moves.
+        static chess::Move pickMove(chess::MoveList &moves, std::array<int, 256> &scores, unsigned from) noexcept
+        {
+            auto best = from;
+            for (auto i = from + 1; i < moves.size(); i++)
+                if (scores[i] > scores[best]) best = i;
+
+            std::swap(moves[from], moves[best]);
+            std::swap(scores[from], scores[best]);
+            return moves[from];
+        }
+
+        template<chess::Color C>
+        static void updateQuiet(Thread &thread, chess::Move move, int depth, int ply) noexcept
+        {
+            if (thread.killers[ply][0] != move)
+            {
+                thread.killers[ply][1] = thread.killers[ply][0];
+                thread.killers[ply][0] = move;
+            }
+
+            auto &history = thread.history[C == chess::Color::Black];
+            auto &entry = history[move.from()][move.to()];
+            entry += depth * depth;
+            if (entry >= s_historyLimit)
+                for (auto &row: history)
+                    for (auto &value: row)
+                        value /= 2;
+        }
+
+        static void updatePv(Thread &thread, chess::Move move, int ply) noexcept
+        {
+            auto &line = thread.pv[ply];
+            line[0] = move;
+            const auto childLength = ply + 1 < MaxPly ? thread.pvLength[ply + 1] : 0;
+            for (int i = 0; i < childLength; i++)
+                line[i + 1] = thread.pv[ply + 1][i];
+            thread.pvLength[ply] = childLength + 1;
+        }
+
+        template<chess::Color C>
+        [[nodiscard]] score_t drawScore(const Thread &thread) const noexcept
+        {
+            return C == thread.rootTurn ? DrawScore - m_options.contempt : DrawScore + m_options.contempt;
+        }
+
+        template<chess::Color C>
+        [[nodiscard]] static score_t evaluate(Thread &thread) noexcept
+        {
+            bool hit;
+            const auto &pawns = thread.pawns.probe(thread.board, hit);
+            thread.counters.increment(Counter::PawnProbes);
+            if (hit) thread.counters.increment(Counter::PawnHits);
+            return Evaluation::evaluate<C>(thread.board, pawns);
+        }
+
+        // One well-predicted branch per node when tracing is off.
+        static void trace(Thread &thread, int ply, int depth, NodeType type, Decision decision, score_t alpha, score_t beta, score_t score) noexcept
+        {
+            if (thread.trace == nullptr) [[likely]] return;
+            thread.trace->push({thread.path[ply].data(), static_cast<std::uint8_t>(ply), type, decision, static_cast<std::uint8_t>(std::max(depth, 0)),
+                                static_cast<std::int16_t>(alpha), static_cast<std::int16_t>(beta), static_cast<std::int16_t>(score)});
+        }
+
+        // Both recursions are instantiated per side to move and alternate between the two, so nothing below asks the
+        // board whose turn it is.
+        template<chess::Color C>
+        score_t quiescence(Thread &thread, score_t alpha, score_t beta, int ply) noexcept
+        {
+            thread.nodes++;
+            thread.counters.increment(Counter::QuiescenceNodes);
+            checkLimits(thread);
+            if (m_stop.load(std::memory_order_relaxed)) return 0;
+
+            auto &board = thread.board;
+            const auto standPat = evaluate<C>(thread);
+            if (ply >= MaxPly - 1 || standPat >= beta)
+            {
+                trace(thread, ply, 0, NodeType::Quiescence, Decision::StandPat, alpha, beta, standPat);
+                return standPat;
+            }
+            const auto originalAlpha = alpha;
+            if (standPat > alpha) alpha = standPat;
+
+            chess::MoveList moves;
+            board.generateCaptures<C>(moves);
+            std::array<int, 256> scores;
+            scoreMoves<C>(thread, moves, scores, chess::Move(), ply);
+
+            auto best = standPat;
+            for (unsigned i = 0; i < moves.size(); i++)
+            {
+                const auto move = pickMove(moves, scores, i);
+                chess::Board::Undo undo;
+                if (!board.make<C>(move, undo)) continue;
+                thread.path[ply + 1] = move;
+                const auto score = -quiescence<chess::Colored::Opposite<C>>(thread, -beta, -alpha, ply + 1);
+                board.unmake<C>(move, undo);
+
+                if (m_stop.load(std::memory_order_relaxed)) return 0;
+                if (score > best)
+                {
+                    best = score;
+                    if (score > alpha) alpha = score;
+                    if (score >= beta) break;
+                }
+            }
+            trace(thread, ply, 0, NodeType::Quiescence, Decision::Searched, originalAlpha, beta, best);
+            return best;
+        }
+
+        // Side to move has at most one piece besides pawns and king: where passing can be better than any move.
+        template<chess::Color C>
+        [[nodiscard]] static int nonPawnPieces(const chess::Board &board) noexcept
+        {
+            const auto pawnsAndKing = board.pieces(chess::Colored::Pawn<C>) | board.pieces(chess::Colored::King<C>);
+            return __builtin_popcountll(board.pieces(C) & ~pawnsAndKing);
+        }
+
+        template<chess::Color C>
+        score_t negamax(Thread &thread, score_t alpha, score_t beta, int depth, int ply, bool nullAllowed = true) noexcept
+        {
+            constexpr auto Them = chess::Colored::Opposite<C>;
+            thread.pvLength[ply] = 0;
+
+            auto &board = thread.board;
+            const bool inCheck = board.inCheck<C>();
+            if (inCheck && m_options.checkExtensions) depth++;
+            if (depth <= 0) return quiescence<C>(thread, alpha, beta, ply);
+
+            thread.nodes++;
+            checkLimits(thread);
+            if (m_stop.load(std::memory_order_relaxed)) return 0;
+
+            const bool root = ply == 0;
+            const bool pvNode = beta - alpha > 1;
+            if (!root)
+            {
+                if (board.isRepetition() || board.isFiftyMoveDraw() || board.isInsufficientMaterial())
+                {
+                    const auto score = drawScore<C>(thread);
+                    trace(thread, ply, depth, NodeType::All, Decision::Draw, alpha, beta, score);
+                    return score;
+                }
+                if (ply >= MaxPly - 1) return evaluate<C>(thread);
+            }
+
+            TableEntry entry{};
+            thread.counters.increment(Counter::TableProbes);
+            const bool hit = m_table.probe(board.key(), ply, entry);
+            if (hit)
+            {
+                thread.counters.increment(Counter::TableHits);
+                if (!pvNode && entry.depth >= depth &&
+                    (entry.bound == Bound::Exact || (entry.bound == Bound::Lower && entry.score >= beta) ||
+                     (entry.bound == Bound::Upper && entry.score <= alpha)))
+                {
+                    thread.counters.increment(Counter::TableCutoffs);
+                    trace(thread, ply, depth, entry.score >= beta ? NodeType::Cut : NodeType::All, Decision::TableCutoff, alpha, beta, entry.score);
+                    return entry.score;
+                }
+            }
+            const auto ttMove = hit ? entry.move : chess::Move();
+
+            // Node-level pruning, only where a wrong guess cannot cost the principal variation or miss a mate.
+            const bool prunable = !pvNode && !inCheck && !isMate(beta);
+            const auto staticEval = prunable ? evaluate<C>(thread) : -Infinity;
+            if (prunable)
+            {
+                if (m_options.reverseFutility && depth <= s_reverseFutilityDepth && staticEval - s_reverseFutilityMargin * depth >= beta)
+                {
+                    trace(thread, ply, depth, NodeType::Cut, Decision::Futility, alpha, beta, staticEval);
+                    return staticEval;
+                }
+
+                if (m_options.razoring && depth <= s_razoringDepth && staticEval + s_razoringMargin * depth < alpha)
+                {
+                    const auto score = quiescence<C>(thread, alpha, beta, ply);
+                    if (score < alpha)
+                    {
+                        trace(thread, ply, depth, NodeType::All, Decision::Razoring, alpha, beta, score);
+                        return score;
+                    }
+                }
+
+                const auto pieces = nonPawnPieces<C>(board);
+                if (m_options.nullMove && nullAllowed && depth >= s_nullMoveDepth && staticEval >= beta && pieces > 0)
+                {
+                    const auto reduction = 3 + depth / 6;
+                    chess::Board::Undo undo;
+                    board.makeNull<C>(undo);
+                    thread.path[ply + 1] = chess::Move();
+                    auto score = -negamax<Them>(thread, -beta, -beta + 1, depth - 1 - reduction, ply + 1, false);
+                    board.unmakeNull<C>(undo);
+                    if (m_stop.load(std::memory_order_relaxed)) return 0;
+
+                    if (score >= beta)
+                    {
+                        if (isMate(score)) score = beta;
+
+                        // With a single piece left zugzwang is likely, so a reduced search without the null move
+                        // has to confirm the cutoff.
+                        bool confirmed = true;
+                        if (pieces <= 1)
+                        {
+                            thread.counters.increment(Counter::NullMoveReSearches);
+                            confirmed = negamax<C>(thread, beta - 1, beta, depth - 1 - reduction, ply, false) >= beta;
+                            if (m_stop.load(std::memory_order_relaxed)) return 0;
+                        }
+                        if (confirmed)
+                        {
+                            trace(thread, ply, depth, NodeType::Cut, Decision::NullMove, alpha, beta, score);
+                            return score;
+                        }
+                    }
+                }
+            }
+
+            chess::MoveList moves;
+            board.generate<C>(moves);
+            std::array<int, 256> scores;
+            scoreMoves<C>(thread, moves, scores, ttMove, ply);
+
+            const bool futile = prunable && m_options.futility && depth <= s_futilityDepth && staticEval + s_futilityMargin * depth <= alpha;
+            const auto originalAlpha = alpha;
+            auto best = -Infinity;
+            chess::Move bestMove;
+            int legal = 0;
+            for (unsigned i = 0; i < moves.size(); i++)
+            {
+                const auto move = pickMove(moves, scores, i);
+                if (root && std::find(thread.excluded.begin(), thread.excluded.end(), move) != thread.excluded.end()) continue;
+                const bool quiet = board.pieceAt(move.to()) == chess::Piece::None && move.promotion() == chess::Promotion::None;
+
+                chess::Board::Undo undo;
+                if (!board.make<C>(move, undo)) continue;
+                legal++;
+                thread.path[ply + 1] = move;
+
+                const bool givesCheck = board.inCheck<Them>();
+                if (futile && quiet && legal > 1 && !givesCheck)
+                {
+                    board.unmake<C>(move, undo);
+                    trace(thread, ply + 1, depth - 1, NodeType::All, Decision::Futility, -beta, -alpha, -staticEval);
+                    if (best < staticEval) best = staticEval;
+                    continue;
+                }
+
+                score_t score;
+                if (legal == 1) score = -negamax<Them>(thread, -beta, -alpha, depth - 1, ply + 1);
+                else
+                {
+                    // Late quiet moves are searched shallower first and only re-searched if they beat alpha anyway.
+                    int reduction = 0;
+                    if (m_options.lateMoveReductions && depth >= s_lmrDepth && legal > s_lmrMoves && quiet && !inCheck && !givesCheck)
+                        reduction = std::clamp(s_reductions[std::min(depth, MaxPly - 1)][std::min(legal, 255)] - pvNode, 0, depth - 2);
+
+                    score = -negamax<Them>(thread, -alpha - 1, -alpha, depth - 1 - reduction, ply + 1);
+                    if (reduction > 0 && score > alpha)
+                    {
+                        thread.counters.increment(Counter::LmrReSearches);
+                        score = -negamax<Them>(thread, -alpha - 1, -alpha, depth - 1, ply + 1);
+                    }
+                    if (score > alpha && score < beta) score = -negamax<Them>(thread, -beta, -alpha, depth - 1, ply + 1);
+                }
+                board.unmake<C>(move, undo);
+
+                if (m_stop.load(std::memory_order_relaxed)) return 0;
+                if (score > best)
+                {
+                    best = score;
+                    bestMove = move;
+                    if (score > alpha)
+                    {
+                        alpha = score;
+                        updatePv(thread, move, ply);
+                        if (score >= beta)
+                        {
+                            thread.counters.increment(Counter::BetaCutoffs);
+                            if (legal == 1) thread.counters.increment(Counter::FirstMoveCutoffs);
+                            if (quiet) updateQuiet<C>(thread, move, depth, ply);
+                            break;
+                        }
+                    }
+                }
+            }
+
+            if (legal == 0)
+            {
+                const auto score = inCheck ? -MateScore + ply : drawScore<C>(thread);
+                trace(thread, ply, depth, NodeType::All, inCheck ? Decision::Mate : Decision::Stalemate, originalAlpha, beta, score);
+                return score;
+            }
+
+            // A root searched with moves excluded is not the position's real result.
+            const auto bound = best >= beta ? Bound::Lower : best > originalAlpha ? Bound::Exact : Bound::Upper;
+            if (!root || thread.excluded.empty()) m_table.store(board.key(), ply, bestMove, best, depth, bound);
+            trace(thread, ply, depth, bound == Bound::Lower ? NodeType::Cut : bound == Bound::Exact ? NodeType::Pv : NodeType::All, Decision::Searched,
+                  originalAlpha, beta, best);
+            return best;
+        }
+
+        // The one place the side to move is read at run time.
+        score_t searchRoot(Thread &thread, score_t alpha, score_t beta, int depth) noexcept
+        {
+            return thread.board.turn() == chess::Color::White ? negamax<chess::Color::White>(thread, alpha, beta, depth, 0)
+                                                              : negamax<chess::Color::Black>(thread, alpha, beta, depth, 0);
+        }
+
+        // Helpers start at alternating depths so they are not all in lockstep with the main thread.
+        void helper(Thread &thread) noexcept
+        {
+            for (int depth = 1 + (thread.id & 1); depth < MaxPly && !m_stop.load(std::memory_order_relaxed); depth++)
+                searchRoot(thread, -Infinity, Infinity, depth);
+        }
+
+        [[nodiscard]] static int legalMoves(chess::Board &board) noexcept
+        {
+            chess::MoveList moves;
+            board.generate(moves);
+            int legal = 0;
+            for (const auto move: moves)
+            {
+                chess::Board::Undo undo;
+                if (!board.make(move, undo)) continue;
+                board.unmake(move, undo);
+                legal++;
+            }
+            return legal;
+        }
+
+        // Each depth finds the MultiPV lines one at a time, every search excluding the root moves found before it.
+        // They share the table, so the later ones run mostly on cutoffs the first one left behind.
+        void iterate(Thread &main)
+        {
+            Info info;
+            const auto lineCount = std::max(1, std::min(m_options.multiPv, legalMoves(main.board)));
+            for (int depth = 1; depth <= std::min(m_limits.depth, MaxPly - 1); depth++)
+            {
+                std::vector<PvLine> lines;
+                main.excluded.clear();
+                bool interrupted = false;
+                for (int line = 0; line < lineCount && !interrupted; line++)
+                {
+                    // No remaining move should beat the line before it, so that bounds the window; one that does anyway is searched again.
+                    const auto ceiling = lines.empty() ? Infinity : lines.back().score + 1;
+                    auto score = searchRoot(main, -Infinity, ceiling, depth);
+                    if (score >= ceiling && !m_stop.load(std::memory_order_relaxed)) score = searchRoot(main, -Infinity, Infinity, depth);
+                    // Only the first line of the first iteration is kept when interrupted, there is nothing else to play.
+                    interrupted = m_stop.load(std::memory_order_relaxed) && (depth > 1 || line > 0);
+                    if (interrupted) break;
+
+                    lines.push_back({score, std::vector<chess::Move>(main.pv[0].begin(), main.pv[0].begin() + main.pvLength[0])});
+                    if (main.pvLength[0] == 0) break;
+                    main.excluded.push_back(main.pv[0][0]);
+                }
+                main.excluded.clear();
+                if (lines.empty() || (interrupted && depth > 1)) break;
+
+                std::stable_sort(lines.begin(), lines.end(), [](const PvLine &a, const PvLine &b) { return a.score > b.score; });
+                m_statistics.iterationNodes.push_back(main.nodes - info.nodes);
+                info.depth = depth;
+                info.score = lines.front().score;
+                info.nodes = main.nodes;
+                info.seconds = elapsed();
+                info.pv = lines.front().pv;
+                info.lines = std::move(lines);
+                if (m_onIteration) m_onIteration(info);
+                if (m_stop.load(std::memory_order_relaxed)) break;
+            }
+
+            // UCI forbids answering a ponder or infinite search before it is told to stop.
+            {
+                std::unique_lock lock(m_mutex);
+                m_release.wait(lock, [this] { return m_stop.load() || !(m_pondering.load() || m_limits.infinite); });
+            }
+
+            m_result = std::move(info);
+            m_stop.store(true);
+        }
+
+        // Runs after every thread of a search is back: totals up and reports.
+        void finish()
+        {
+            for (const auto &thread: m_threads)
+            {
+                m_statistics.nodes += thread->nodes;
+                m_statistics.counters += thread->counters;
+            }
+            m_result.nodes = m_statistics.nodes;
+            m_result.seconds = elapsed();
+            if (m_onFinish) m_onFinish(m_result);
+        }
+
+        // seen is the generation current when the thread was created, so it waits for the next search.
+        void work(unsigned index, std::uint64_t seen)
+        {
+            while (true)
+            {
+                {
+                    std::unique_lock lock(m_mutex);
+                    m_wake.wait(lock, [&] { return m_quit || m_generation != seen; });
+                    if (m_quit) return;
+                    seen = m_generation;
+                }
+
+                auto &thread = *m_threads[index];
+                if (index == 0) iterate(thread);
+                else helper(thread);
+
+                bool last;
+                {
+                    const std::scoped_lock lock(m_mutex);
+                    last = --m_running == 0;
+                }
+                if (last)
+                {
+                    finish();
+                    {
+                        const std::scoped_lock lock(m_mutex);
+                        m_finished = true;
+                    }
+                    m_done.notify_all();
+                }
+            }
+        }
+
+        void shutdown()
+        {
+            {
+                const std::scoped_lock lock(m_mutex);
+                m_quit = true;
+            }
+            m_wake.notify_all();
+            m_pool.clear();
+            m_quit = false;
+        }
+
+        // Only between searches. Heuristics of surviving threads are kept. A search of several threads spreads them
+        // over the NUMA nodes, one per CPU, and a new thread sets up its state once pinned so that it is allocated
+        // on its own node. A single thread is left to the scheduler: it is usually one of many on the machine.
+        void resize(unsigned count)
+        {
+            const bool pin = m_pinning && count > 1;
+            if (count == m_threads.size() && pin == m_pinned) return;
+            shutdown();
+            m_threads.resize(count);
+            m_pinned = pin;
+            if (pin) (void) Topology::system(); // Read here, before any thread is bound.
+
+            std::latch ready(count);
+            for (unsigned i = 0; i < count; i++)
+                m_pool.emplace_back([this, i, pin, &ready, generation = m_generation]
+                {
+                    if (pin) (void) Topology::system().pin(i);
+                    if (!m_threads[i]) m_threads[i] = std::make_unique<Thread>(i);
+                    ready.count_down();
+                    work(i, generation);
+                });
+            ready.wait();
+        }
+
+    public:
+        explicit Search(TranspositionTable &table)
+                : m_table(table), m_stop(false), m_pondering(false), m_clockStart(0), m_limits(), m_start(), m_statistics(), m_tracer(nullptr),
+                  m_options(), m_threads(), m_pool(), m_mutex(), m_wake(), m_done(), m_release(), m_generation(0), m_running(0), m_finished(true), m_quit(false),
+                  m_pinning(true), m_pinned(false), m_root(), m_onIteration(), m_onFinish(), m_result() {}
+
+        Search(const Search &) = delete;
+
+        Search &operator=(const Search &) = delete;
+
+        ~Search()
+        {
+            stop();
+            wait();
+            shutdown();
+        }
+
+        // Records every node into the tracer's per-thread buffers while set; nullptr turns tracing off.
+        void setTracer(Tracer *tracer) noexcept { m_tracer = tracer; }
+
+        // Takes effect from the next search.
+        void setOptions(const Options &options) noexcept { m_options = options; }
+
+        // Off for an engine sharing the machine with others, which would all bind to the same CPUs. Takes effect
+        // from the next search.
+        void setPinning(bool pinning) noexcept { m_pinning = pinning; }
+
+        [[nodiscard]] const Options &options() const noexcept { return m_options; }
+
+        // Forgets killers and history, for a new game or a reproducible search. The table is the owner's to clear.
+        void clear() noexcept
+        {
+            for (auto &thread: m_threads)
+            {
+                thread->killers = {};
+                thread->history = {};
+            }
+        }
+
+        // Safe to call from another thread while a search is in progress.
+        void stop() noexcept
+        {
+            {
+                const std::scoped_lock lock(m_mutex);
+                m_stop.store(true, std::memory_order_relaxed);
+            }
+            m_release.notify_all();
+        }
+
+        // The predicted move was played: the ponder search carries on as a normal one, its clock starting now.
+        void ponderhit() noexcept
+        {
+            m_clockStart.store(clock_t::now().time_since_epoch().count(), std::memory_order_relaxed);
+            {
+                const std::scoped_lock lock(m_mutex);
+                m_pondering.store(false);
+            }
+            m_release.notify_all();
+        }
+
+        // Starts a search on the persistent threads and returns at once. onIteration is called from the main search
+        // thread after each completed depth, onFinish from whichever thread finishes last.
+        void start(const chess::Board &board, const Limits &limits, unsigned threads = 1, std::function<void(const Info &)> onIteration = {},
+                   std::function<void(const Info &)> onFinish = {})
+        {
+            wait();
+            resize(std::max(1u, threads));
+
+            m_root = board;
+            m_limits = limits;
+            m_onIteration = std::move(onIteration);
+            m_onFinish = std::move(onFinish);
+            m_statistics = SearchStatistics();
+            m_result = Info();
+            for (const auto &thread: m_threads)
+            {
+                thread->board = board;
+                thread->rootTurn = board.turn();
+                thread->nodes = 0;
+                thread->counters = Counters();
+                thread->pvLength = {};
+                thread->trace = m_tracer ? &m_tracer->buffer(thread->id) : nullptr;
+                // Older history still orders moves but should give way to what this search learns.
+                for (auto &side: thread->history)
+                    for (auto &row: side)
+                        for (auto &value: row)
+                            value /= 2;
+            }
+
+            m_start = clock_t::now();
+            m_clockStart.store(m_start.time_since_epoch().count());
+            m_pondering.store(limits.ponder);
+            m_stop.store(false);
+            {
+                const std::scoped_lock lock(m_mutex);
+                m_running = static_cast<unsigned>(m_threads.size());
+                m_finished = false;
+                m_generation++;
+            }
+            m_wake.notify_all();
+        }
+
+        // Blocks until the current search, if any, has finished, and returns its last completed iteration with nodes
+        // totalled over all threads.
+        Info wait()
+        {
+            std::unique_lock lock(m_mutex);
+            m_done.wait(lock, [this] { return m_finished; });
+            return m_result;
+        }
+
+        Info run(const chess::Board &board, const Limits &limits, unsigned threads = 1, std::function<void(const Info &)> onIteration = {})
+        {
+            start(board, limits, threads, std::move(onIteration));
+            return wait();
+        }
+
+        // Counters of the last search, summed over its threads.
+        [[nodiscard]] const SearchStatistics &statistics() const noexcept { return m_statistics; }
+    };
+} // namespace engine
+
+#endif // CHESS_ENGINE_SEARCH_H
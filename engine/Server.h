@@ -0,0 +1,376 @@
+#ifndef CHESS_ENGINE_SERVER_H
+#define CHESS_ENGINE_SERVER_H
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "Scheduler.h"
+#include "Search.h"
+#include "TranspositionTable.h"
+#include "Uci.h"
+#include "chess/Board.hpp"
+
+namespace engine
+{
+    // Many clients on one Unix domain socket, each a session with its own position and options, all searching
+    // through one Scheduler and so one table. The protocol is line based and close to UCI:
+    //
+    //   position ...                      as in UCI
+    //   setoption name <id> value <x>     search options only: Hash and Threads belong to the server
+    //   go [priority <n>] ...             as in UCI, answered "job <id> queued" then "job <id> info ..." and
+    //                                     "job <id> bestmove ..."; several may be outstanding
+    //   cancel [<id>]                     one job or every job of the session; "job <id> cancelled" if it never ran
+    //   status, isready, quit
+    //
+    // One thread does all socket I/O with poll(). Search threads only append to a session's output and wake it
+    // through a pipe, so a slow client never holds up a search. All "go" lines read in one round are submitted
+    // together, unless a "cancel" or "quit" among them needs them submitted first.
+    class Server
+    {
+        static constexpr const std::size_t s_maxLine = 1 << 16;
+
+        struct Session
+        {
+            std::uint64_t id;
+            int fd;
+            std::string input{};
+            std::mutex outputMutex{};
+            std::string output{};
+            chess::Board board;
+            Options options{};
+            bool quitting = false; // Closed once its output is out.
+            bool closed = false;
+
+            Session(std::uint64_t sessionId, int socket) : id(sessionId), fd(socket), board(std::string(StartingFen)) {}
+        };
+
+        std::string m_path;
+        TranspositionTable m_table;
+        std::unique_ptr<Scheduler> m_scheduler;
+        int m_listener;
+        std::array<int, 2> m_wake;
+        std::unordered_map<int, std::shared_ptr<Session>> m_sessions;
+        std::uint64_t m_nextSession;
+        std::atomic<bool> m_stop;
+
+        [[noreturn]] static void fail(const std::string &what) { throw std::runtime_error(what + ": " + std::strerror(errno)); }
+
+        static void setNonBlocking(int fd)
+        {
+            if (fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) < 0) fail("fcntl");
+        }
+
+        void wake() noexcept
+        {
+            const char byte = 0;
+            (void) !write(m_wake[1], &byte, 1); // A full pipe already has a wake-up pending.
+        }
+
+        // From any thread.
+        void post(Session &session, const std::string &line)
+        {
+            {
+                const std::scoped_lock lock(session.outputMutex);
+                session.output += line;
+                session.output += '\n';
+            }
+            wake();
+        }
+
+        [[nodiscard]] Job job(const std::shared_ptr<Session> &session, std::istringstream &in)
+        {
+            // priority is the server's own; everything else is handed to the UCI parser.
+            int priority = 0;
+            std::string rest, token;
+            while (in >> token)
+            {
+                if (token == "priority") in >> priority;
+                else rest += token + ' ';
+            }
+            std::istringstream goTokens(rest);
+
+            Job job;
+            job.limits = parseLimits(goTokens, session->board.turn()); // First, so a malformed "go" takes no id.
+            job.id = m_scheduler->reserveId();
+            job.owner = session->id;
+            job.priority = priority;
+            job.position = session->board.state();
+            job.history.assign(session->board.history().begin(), session->board.history().end());
+            job.limits.ponder = false; // There is no ponderhit to end it.
+            job.options = session->options;
+
+            const auto prefix = "job " + std::to_string(job.id) + ' ';
+            const bool numbered = job.options.multiPv > 1;
+            job.onIteration = [this, session, prefix, numbered](const Info &iteration)
+            {
+                for (const auto &line: infoLines(iteration, numbered))
+                    post(*session, prefix + line);
+            };
+            job.onFinish = [this, session, prefix](const Info &info, bool cancelled)
+            {
+                post(*session, prefix + (cancelled && info.depth == 0 ? std::string("cancelled") : bestMoveLine(info)));
+            };
+            return job;
+        }
+
+        // Jobs read so far this round; the scheduler can only cancel a job once it has it.
+        void submit(std::vector<Job> &jobs)
+        {
+            if (!jobs.empty()) (void) m_scheduler->submit(std::exchange(jobs, {}));
+        }
+
+        // A line that does not parse is answered with an info string and leaves the session as it was: one client's
+        // mistake must not take the server, and every other session, down with it.
+        void handle(const std::shared_ptr<Session> &session, const std::string &line, std::vector<Job> &jobs)
+        {
+            std::istringstream tokens(line);
+            std::string command;
+            tokens >> command;
+
+            if (command == "position")
+            {
+                try
+                {
+                    session->board = parsePosition(tokens);
+                }
+                catch (const std::runtime_error &)
+                {
+                    post(*session, "info string invalid position");
+                }
+            }
+            else if (command == "go")
+            {
+                try
+                {
+                    jobs.push_back(job(session, tokens));
+                    post(*session, "job " + std::to_string(jobs.back().id) + " queued");
+                }
+                catch (const std::runtime_error &error)
+                {
+                    post(*session, std::string("info string invalid go: ") + error.what());
+                }
+            }
+            else if (command == "setoption")
+            {
+                std::string token, name, value;
+                tokens >> token >> name >> token >> value; // name <id> value <x>
+                auto options = session->options;
+                if (options.set(name, value)) session->options = options;
+                else post(*session, "info string invalid option " + name);
+            }
+            else if (command == "cancel")
+            {
+                submit(jobs);
+                std::uint64_t id = 0;
+                if (tokens >> id) m_scheduler->cancel(session->id, id);
+                else m_scheduler->cancelOwner(session->id);
+            }
+            else if (command == "status")
+            {
+                const auto status = m_scheduler->status();
+                post(*session, "status workers " + std::to_string(m_scheduler->workers()) + " queued " + std::to_string(status.queued) +
+                               " running " + std::to_string(status.running) + " completed " + std::to_string(status.completed) + " sessions " +
+                               std::to_string(m_sessions.size()));
+            }
+            else if (command == "isready") post(*session, "readyok");
+            else if (command == "quit")
+            {
+                submit(jobs);
+                m_scheduler->cancelOwner(session->id);
+                session->quitting = true;
+            }
+            else if (!command.empty()) post(*session, "info string unknown command " + command);
+        }
+
+        void receive(const std::shared_ptr<Session> &session, std::vector<Job> &jobs)
+        {
+            std::array<char, 4096> buffer;
+            while (true)
+            {
+                const auto count = read(session->fd, buffer.data(), buffer.size());
+                if (count > 0)
+                {
+                    session->input.append(buffer.data(), static_cast<std::size_t>(count));
+                    continue;
+                }
+                if (count < 0 && errno == EAGAIN) break;
+                if (count < 0 && errno == EINTR) continue;
+                session->closed = true;
+                break;
+            }
+
+            std::size_t start = 0;
+            for (auto end = session->input.find('\n'); end != std::string::npos && !session->quitting; end = session->input.find('\n', start))
+            {
+                auto line = session->input.substr(start, end - start);
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+                handle(session, line, jobs);
+                start = end + 1;
+            }
+            session->input.erase(0, start);
+            if (session->input.size() > s_maxLine) session->closed = true;
+        }
+
+        void flush(Session &session)
+        {
+            const std::scoped_lock lock(session.outputMutex);
+            while (!session.output.empty())
+            {
+                const auto count = send(session.fd, session.output.data(), session.output.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+                if (count < 0)
+                {
+                    if (errno == EINTR) continue;
+                    if (errno != EAGAIN) session.closed = true;
+                    break;
+                }
+                session.output.erase(0, static_cast<std::size_t>(count));
+            }
+            if (session.quitting && session.output.empty()) session.closed = true;
+        }
+
+        [[nodiscard]] bool pendingOutput(Session &session)
+        {
+            const std::scoped_lock lock(session.outputMutex);
+            return !session.output.empty();
+        }
+
+        void accept()
+        {
+            while (true)
+            {
+                const int fd = ::accept(m_listener, nullptr, nullptr);
+                if (fd < 0)
+                {
+                    if (errno == EINTR) continue;
+                    if (errno == EAGAIN) return;
+                    fail("accept");
+                }
+                setNonBlocking(fd);
+                m_sessions.emplace(fd, std::make_shared<Session>(m_nextSession++, fd));
+            }
+        }
+
+        void close(const std::shared_ptr<Session> &session)
+        {
+            m_scheduler->cancelOwner(session->id);
+            ::close(session->fd);
+            m_sessions.erase(session->fd);
+        }
+
+    public:
+        Server(std::string path, unsigned workers, std::size_t megabytes = 16)
+                : m_path(std::move(path)), m_table(megabytes), m_scheduler(), m_listener(-1), m_wake{-1, -1}, m_sessions(), m_nextSession(1),
+                  m_stop(false)
+        {
+            sockaddr_un address{};
+            address.sun_family = AF_UNIX;
+            if (m_path.size() >= sizeof(address.sun_path)) throw std::runtime_error("socket path too long: " + m_path);
+            std::memcpy(address.sun_path, m_path.c_str(), m_path.size() + 1);
+
+            if (pipe(m_wake.data()) < 0) fail("pipe");
+            setNonBlocking(m_wake[0]);
+            setNonBlocking(m_wake[1]);
+
+            m_listener = socket(AF_UNIX, SOCK_STREAM, 0);
+            if (m_listener < 0) fail("socket");
+            unlink(m_path.c_str()); // Left behind by a server that did not shut down cleanly.
+            if (bind(m_listener, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) < 0) fail("bind " + m_path);
+            if (listen(m_listener, SOMAXCONN) < 0) fail("listen");
+            setNonBlocking(m_listener);
+
+            m_scheduler = std::make_unique<Scheduler>(m_table, workers);
+        }
+
+        Server(const Server &) = delete;
+
+        Server &operator=(const Server &) = delete;
+
+        // The scheduler goes first: its threads are the only other users of the pipe and the sessions.
+        ~Server()
+        {
+            m_scheduler.reset();
+            for (const auto &[fd, session]: m_sessions)
+                ::close(fd);
+            if (m_listener >= 0)
+            {
+                ::close(m_listener);
+                unlink(m_path.c_str());
+            }
+            for (const auto fd: m_wake)
+                if (fd >= 0) ::close(fd);
+        }
+
+        // Serves clients until stop().
+        void run()
+        {
+            std::vector<pollfd> fds;
+            std::vector<std::shared_ptr<Session>> polled;
+            while (!m_stop.load())
+            {
+                fds.clear();
+                polled.clear();
+                fds.push_back({m_listener, POLLIN, 0});
+                fds.push_back({m_wake[0], POLLIN, 0});
+                for (const auto &[fd, session]: m_sessions)
+                {
+                    fds.push_back({fd, static_cast<short>(POLLIN | (pendingOutput(*session) ? POLLOUT : 0)), 0});
+                    polled.push_back(session);
+                }
+
+                if (poll(fds.data(), fds.size(), -1) < 0)
+                {
+                    if (errno == EINTR) continue;
+                    fail("poll");
+                }
+
+                if (fds[1].revents & POLLIN)
+                {
+                    std::array<char, 256> drain;
+                    while (read(m_wake[0], drain.data(), drain.size()) > 0) {}
+                }
+
+                std::vector<Job> jobs;
+                for (std::size_t i = 0; i < polled.size(); i++)
+                {
+                    const auto &session = polled[i];
+                    if (fds[i + 2].revents & (POLLIN | POLLHUP | POLLERR)) receive(session, jobs);
+                    flush(*session);
+                }
+                submit(jobs);
+
+                for (const auto &session: polled)
+                    if (session->closed) close(session);
+
+                if (fds[0].revents & POLLIN) accept();
+            }
+        }
+
+        // From any thread.
+        void stop() noexcept
+        {
+            m_stop.store(true);
+            wake();
+        }
+    };
+} // namespace engine
+
+#endif // CHESS_ENGINE_SERVER_H
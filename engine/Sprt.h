@@ -0,0 +1,88 @@
+#ifndef CHESS_ENGINE_SPRT_H
+#define CHESS_ENGINE_SPRT_H
+
+#include <cmath>
+#include <cstdint>
+
+namespace engine
+{
+    // Wins, draws and losses of one engine against another.
+    struct MatchScore
+    {
+        std::uint64_t wins = 0;
+        std::uint64_t draws = 0;
+        std::uint64_t losses = 0;
+
+        [[nodiscard]] std::uint64_t games() const noexcept { return wins + draws + losses; }
+
+        [[nodiscard]] double score() const noexcept { return games() ? (double(wins) + 0.5 * double(draws)) / double(games()) : 0.5; }
+
+        // Per-game variance of the score.
+        [[nodiscard]] double variance() const noexcept
+        {
+            if (!games()) return 0.0;
+            const auto n = double(games()), x = score();
+            return (double(wins) * (1 - x) * (1 - x) + double(draws) * (0.5 - x) * (0.5 - x) + double(losses) * x * x) / n;
+        }
+
+        [[nodiscard]] static double elo(double score) noexcept
+        {
+            if (score <= 0.0 || score >= 1.0) return score <= 0.0 ? -INFINITY : INFINITY;
+            return -400.0 * std::log10(1.0 / score - 1.0);
+        }
+
+        [[nodiscard]] double elo() const noexcept { return elo(score()); }
+
+        // Half width of the 95% confidence interval.
+        [[nodiscard]] double eloError() const noexcept
+        {
+            if (!games()) return 0.0;
+            const auto margin = 1.959964 * std::sqrt(variance() / double(games()));
+            return (elo(score() + margin) - elo(score() - margin)) / 2.0;
+        }
+    };
+
+    // Sequential probability ratio test between H0: elo = elo0 and H1: elo = elo1, using the normal approximation
+    // of the log-likelihood ratio for trinomial results.
+    struct Sprt
+    {
+        enum class Decision : unsigned char { Continue, AcceptH0, AcceptH1 };
+
+        double elo0 = 0.0;
+        double elo1 = 5.0;
+        double alpha = 0.05;
+        double beta = 0.05;
+
+        [[nodiscard]] static double expectedScore(double elo) noexcept { return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0)); }
+
+        [[nodiscard]] double lowerBound() const noexcept { return std::log(beta / (1.0 - alpha)); }
+
+        [[nodiscard]] double upperBound() const noexcept { return std::log((1.0 - beta) / alpha); }
+
+        // Score and variance are estimated with half a game added to each outcome, so a run in which one side has
+        // never won or never lost still has a variance and can reach a bound. After a few dozen games the prior no
+        // longer shows.
+        [[nodiscard]] double llr(const MatchScore &match) const noexcept
+        {
+            if (!match.games()) return 0.0;
+
+            const auto wins = double(match.wins) + 0.5, draws = double(match.draws) + 0.5, losses = double(match.losses) + 0.5;
+            const auto n = wins + draws + losses;
+            const auto score = (wins + 0.5 * draws) / n;
+            const auto variance = (wins * (1 - score) * (1 - score) + draws * (0.5 - score) * (0.5 - score) + losses * score * score) / n;
+
+            const auto s0 = expectedScore(elo0), s1 = expectedScore(elo1);
+            return double(match.games()) * (s1 - s0) * (2.0 * score - s0 - s1) / (2.0 * variance);
+        }
+
+        [[nodiscard]] Decision decide(const MatchScore &match) const noexcept
+        {
+            const auto ratio = llr(match);
+            if (ratio >= upperBound()) return Decision::AcceptH1;
+            if (ratio <= lowerBound()) return Decision::AcceptH0;
+            return Decision::Continue;
+        }
+    };
+} // namespace engine
+
+#endif // CHESS_ENGINE_SPRT_H
@@ -0,0 +1,136 @@
+#ifndef CHESS_ENGINE_TRACER_H
+#define CHESS_ENGINE_TRACER_H
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Score.h"
+#include "chess/Move.h"
+
+namespace engine
+{
+    enum class NodeType : std::uint8_t { Pv, Cut, All, Quiescence };
+
+    // Why a node returned the way it did. The pruning decisions are filled in by the selective search.
+    enum class Decision : std::uint8_t { Searched, TableCutoff, Draw, Mate, Stalemate, StandPat, NullMove, Futility, Razoring };
+
+    // One finished node, written as the search leaves it, so a trace is the tree in post-order: a node's children
+    // are the records just before it at one ply deeper.
+    struct TraceRecord
+    {
+        std::uint16_t move;  // The move that led here, Move::data().
+        std::uint8_t ply;
+        NodeType type;
+        Decision decision;
+        std::uint8_t depth;
+        std::int16_t alpha;
+        std::int16_t beta;
+        std::int16_t score;
+    };
+
+    static_assert(sizeof(TraceRecord) == 12, "TraceRecord is written to disk as is");
+
+    // Fixed capacity, allocated up front; once full the oldest records are overwritten.
+    class TraceBuffer
+    {
+        std::vector<TraceRecord> m_records;
+        std::size_t m_mask;
+        std::uint64_t m_written;
+
+    public:
+        explicit TraceBuffer(std::size_t capacity) : m_records(std::bit_ceil(capacity)), m_mask(m_records.size() - 1), m_written(0) {}
+
+        void push(const TraceRecord &record) noexcept { m_records[m_written++ & m_mask] = record; }
+
+        void clear() noexcept { m_written = 0; }
+
+        [[nodiscard]] std::size_t size() const noexcept { return std::min<std::uint64_t>(m_written, m_records.size()); }
+
+        // Oldest first.
+        [[nodiscard]] const TraceRecord &operator[](std::size_t i) const noexcept { return m_records[(m_written - size() + i) & m_mask]; }
+    };
+
+    // Owns one buffer per search thread. File layout, native endian: magic, version, thread count, then per thread a
+    // record count followed by that many records, oldest first.
+    class Tracer
+    {
+        static constexpr const std::uint32_t s_magic = 0x52544543; // "CETR"
+        static constexpr const std::uint16_t s_version = 1;
+
+        std::size_t m_capacity;
+        std::vector<std::unique_ptr<TraceBuffer>> m_buffers;
+        std::string m_path;
+
+    public:
+        // With a path, every finished search is flushed to it; without one, only explicit flush() calls write.
+        explicit Tracer(std::size_t recordsPerThread = 1 << 20, std::string path = "")
+                : m_capacity(recordsPerThread), m_buffers(), m_path(std::move(path)) {}
+
+        // Called by the search before it starts; buffers are reused between searches.
+        TraceBuffer &buffer(unsigned thread)
+        {
+            while (m_buffers.size() <= thread)
+                m_buffers.push_back(std::make_unique<TraceBuffer>(m_capacity));
+            m_buffers[thread]->clear();
+            return *m_buffers[thread];
+        }
+
+        [[nodiscard]] const std::string &path() const noexcept { return m_path; }
+
+        void flush(const std::string &path) const
+        {
+            std::ofstream out(path, std::ios::binary);
+            if (!out) throw std::runtime_error("cannot open trace file " + path);
+
+            const auto threads = static_cast<std::uint16_t>(m_buffers.size());
+            out.write(reinterpret_cast<const char *>(&s_magic), sizeof(s_magic));
+            out.write(reinterpret_cast<const char *>(&s_version), sizeof(s_version));
+            out.write(reinterpret_cast<const char *>(&threads), sizeof(threads));
+            for (const auto &buffer: m_buffers)
+            {
+                const std::uint64_t count = buffer->size();
+                out.write(reinterpret_cast<const char *>(&count), sizeof(count));
+                for (std::size_t i = 0; i < count; i++)
+                    out.write(reinterpret_cast<const char *>(&(*buffer)[i]), sizeof(TraceRecord));
+            }
+        }
+
+        // One vector of records per thread, as flush() wrote them.
+        static std::vector<std::vector<TraceRecord>> read(const std::string &path)
+        {
+            std::ifstream in(path, std::ios::binary);
+            std::uint32_t magic = 0;
+            std::uint16_t version = 0, threads = 0;
+            in.read(reinterpret_cast<char *>(&magic), sizeof(magic));
+            in.read(reinterpret_cast<char *>(&version), sizeof(version));
+            in.read(reinterpret_cast<char *>(&threads), sizeof(threads));
+            if (!in || magic != s_magic || version != s_version) throw std::runtime_error(path + " is not a search trace");
+
+            // The counts are checked against what is left of the file before anything is allocated for them.
+            const auto header = in.tellg();
+            in.seekg(0, std::ios::end);
+            const auto end = in.tellg();
+            in.seekg(header);
+
+            std::vector<std::vector<TraceRecord>> records(threads);
+            for (auto &thread: records)
+            {
+                std::uint64_t count = 0;
+                in.read(reinterpret_cast<char *>(&count), sizeof(count));
+                if (!in || count > static_cast<std::uint64_t>(end - in.tellg()) / sizeof(TraceRecord)) throw std::runtime_error(path + " is truncated");
+                thread.resize(count);
+                in.read(reinterpret_cast<char *>(thread.data()), static_cast<std::streamsize>(count * sizeof(TraceRecord)));
+                if (!in) throw std::runtime_error(path + " is truncated");
+            }
+            return records;
+        }
+    };
+} // namespace engine
+
+#endif // CHESS_ENGINE_TRACER_H
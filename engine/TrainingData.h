@@ -0,0 +1,180 @@
+#ifndef CHESS_ENGINE_TRAINING_DATA_H
+#define CHESS_ENGINE_TRAINING_DATA_H
+
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Score.h"
+#include "chess/Board.hpp"
+
+namespace engine
+{
+    // A labelled position in 32 bytes: the occupancy, then one nibble per occupied square in bit order holding the
+    // Piece value. Score and result are from White's side; result is 0, 1 or 2 for a loss, draw or win.
+    struct PackedPosition
+    {
+        std::uint64_t occupied;
+        std::array<std::uint8_t, 16> pieces;
+        std::int16_t score;
+        std::uint8_t result;
+        std::uint8_t flags;          // Bit 0 set for Black to move, bits 1-4 the castling rights KQkq.
+        std::uint8_t enPassant;      // Square index, 64 for none.
+        std::uint8_t halfMoveClock;
+        std::uint16_t fullMoveNumber;
+
+        static PackedPosition pack(const chess::Board &board, score_t whiteScore, std::uint8_t result) noexcept
+        {
+            PackedPosition packed{board.occupied(), {}, static_cast<std::int16_t>(whiteScore), result, 0, 64,
+                                  static_cast<std::uint8_t>(std::min<int>(board.halfMoveClock(), 255)), board.fullMoveNumber()};
+
+            int i = 0;
+            for (auto bb = packed.occupied; bb; bb &= bb - 1, i++)
+                packed.pieces[i / 2] |= static_cast<std::uint8_t>(std::to_underlying(board.pieceAt(__builtin_ctzll(bb))) << (4 * (i % 2)));
+
+            packed.flags = board.turn() == chess::Color::Black;
+            for (int right = 0; right < 4; right++)
+                if (board.castling(right)) packed.flags |= static_cast<std::uint8_t>(2 << right);
+            if (board.enPassantSquare()) packed.enPassant = static_cast<std::uint8_t>(__builtin_ctzll(board.enPassantSquare()));
+            return packed;
+        }
+
+        // The inverse of pack, without going through FEN.
+        void unpack(chess::Board &board) const noexcept
+        {
+            std::array<chess::Piece, 64> squares;
+            squares.fill(chess::Piece::None);
+            int i = 0;
+            for (auto bb = occupied; bb; bb &= bb - 1, i++)
+                squares[__builtin_ctzll(bb)] = chess::Piece((pieces[i / 2] >> (4 * (i % 2))) & 0xF);
+
+            board.set(squares, flags & 1 ? chess::Color::Black : chess::Color::White, static_cast<std::uint8_t>((flags >> 1) & 0xF), enPassant,
+                      halfMoveClock, fullMoveNumber);
+        }
+
+        [[nodiscard]] chess::Piece piece(int square) const noexcept
+        {
+            if (!(occupied >> square & 1)) return chess::Piece::None;
+            const auto i = __builtin_popcountll(occupied & ((1ULL << square) - 1));
+            return chess::Piece((pieces[i / 2] >> (4 * (i % 2))) & 0xF);
+        }
+
+        [[nodiscard]] std::string fen() const
+        {
+            constexpr std::string_view pieceChars = " PNRBQK  pnrbqk";
+
+            std::string fen;
+            int empty = 0;
+            for (int sq = 63; sq >= 0; sq--)
+            {
+                const auto p = piece(sq);
+                if (p == chess::Piece::None) empty++;
+                else
+                {
+                    if (empty) fen += char('0' + std::exchange(empty, 0));
+                    fen += pieceChars[std::to_underlying(p)];
+                }
+                if (sq % 8 == 0)
+                {
+                    if (empty) fen += char('0' + std::exchange(empty, 0));
+                    if (sq) fen += '/';
+                }
+            }
+
+            fen += flags & 1 ? " b " : " w ";
+            const auto size = fen.size();
+            for (int right = 0; right < 4; right++)
+                if (flags & (2 << right)) fen += "KQkq"[right];
+            if (fen.size() == size) fen += '-';
+
+            if (enPassant == 64) fen += " -";
+            else fen += {' ', char('h' - enPassant % 8), char('1' + enPassant / 8)};
+            return fen + ' ' + std::to_string(halfMoveClock) + ' ' + std::to_string(fullMoveNumber);
+        }
+    };
+
+    static_assert(sizeof(PackedPosition) == 32, "PackedPosition is written to disk as is");
+
+    // Appends records from any thread without making it wait on the disk: whole batches are queued and a writer
+    // thread empties the queue.
+    class TrainingWriter
+    {
+        std::FILE *m_file;
+        std::mutex m_mutex;
+        std::condition_variable m_ready;
+        std::deque<std::vector<PackedPosition>> m_queue;
+        std::uint64_t m_written;
+        bool m_closing;
+        std::jthread m_thread;
+
+        void run()
+        {
+            std::unique_lock lock(m_mutex);
+            while (true)
+            {
+                m_ready.wait(lock, [this] { return m_closing || !m_queue.empty(); });
+                if (m_queue.empty()) return;
+
+                auto batch = std::move(m_queue.front());
+                m_queue.pop_front();
+                lock.unlock();
+                std::fwrite(batch.data(), sizeof(PackedPosition), batch.size(), m_file);
+                lock.lock();
+                m_written += batch.size();
+            }
+        }
+
+    public:
+        explicit TrainingWriter(const std::string &path)
+                : m_file(std::fopen(path.c_str(), "ab")), m_mutex(), m_ready(), m_queue(), m_written(0), m_closing(false), m_thread()
+        {
+            if (!m_file) throw std::runtime_error("cannot open " + path);
+            std::setvbuf(m_file, nullptr, _IOFBF, 1 << 20);
+            m_thread = std::jthread([this] { run(); });
+        }
+
+        TrainingWriter(const TrainingWriter &) = delete;
+
+        TrainingWriter &operator=(const TrainingWriter &) = delete;
+
+        // Writes whatever is still queued before closing.
+        ~TrainingWriter()
+        {
+            {
+                const std::scoped_lock lock(m_mutex);
+                m_closing = true;
+            }
+            m_ready.notify_one();
+            m_thread.join();
+            std::fclose(m_file);
+        }
+
+        void submit(std::vector<PackedPosition> &&batch)
+        {
+            if (batch.empty()) return;
+            {
+                const std::scoped_lock lock(m_mutex);
+                m_queue.push_back(std::move(batch));
+            }
+            m_ready.notify_one();
+        }
+
+        [[nodiscard]] std::uint64_t written()
+        {
+            const std::scoped_lock lock(m_mutex);
+            return m_written;
+        }
+    };
+} // namespace engine
+
+#endif // CHESS_ENGINE_TRAINING_DATA_H
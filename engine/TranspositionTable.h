@@ -0,0 +1,220 @@
+#ifndef CHESS_ENGINE_TRANSPOSITION_TABLE_H
+#define CHESS_ENGINE_TRANSPOSITION_TABLE_H
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+#include "Numa.h"
+#include "Score.h"
+#include "chess/Move.h"
+#include "chess/Zobrist.h"
+
+namespace engine
+{
+    enum class Bound : unsigned char { None, Upper, Lower, Exact };
+
+    struct TableEntry
+    {
+        chess::Move move;
+        score_t score;
+        int depth;
+        Bound bound;
+    };
+
+    // Shared by every search thread without locks. Each slot stores its data next to key ^ data, so a slot torn by
+    // two concurrent writers fails the key check on probe and reads as a miss rather than as some other position.
+    //
+    // Probes land anywhere in the table, so on 4 KB pages nearly every one is a TLB miss once the table is large.
+    // The table is therefore 2 MB aligned and asks the kernel for transparent huge pages, carrying on with small
+    // pages where it gets none. It is first written by threads spread over the NUMA nodes, each taking a
+    // contiguous part: a page lives on the node of the thread that touched it first, so the table ends up split
+    // across the nodes rather than all on the one that allocated it.
+    class TranspositionTable
+    {
+        struct Slot
+        {
+            std::atomic<std::uint64_t> check{0};
+            std::atomic<std::uint64_t> data{0};
+        };
+
+        struct Free
+        {
+            void operator()(Slot *slots) const noexcept { std::free(slots); }
+        };
+
+        static constexpr const std::size_t s_hugePage = 2 * 1024 * 1024;
+        static constexpr const std::size_t s_bytesPerThread = 64 * 1024 * 1024; // Smaller tables are set up in place.
+
+        std::unique_ptr<Slot[], Free> m_slots;
+        std::size_t m_mask;
+        bool m_hugePages; // The kernel took the madvise() request.
+
+        // Runs fill(begin, end) over the slots in contiguous parts, each on a thread pinned round the NUMA nodes.
+        template<typename Fill>
+        void forEachPart(Fill fill)
+        {
+            const auto count = m_mask + 1;
+            const auto &topology = Topology::system();
+            const auto parts = std::clamp<std::size_t>(bytes() / s_bytesPerThread, 1, topology.cpus());
+            if (parts == 1)
+            {
+                fill(std::size_t(0), count);
+                return;
+            }
+
+            std::vector<std::jthread> threads;
+            for (std::size_t part = 0; part < parts; part++)
+                threads.emplace_back([&, part]
+                {
+                    (void) topology.pin(static_cast<unsigned>(part));
+                    fill(count * part / parts, count * (part + 1) / parts);
+                });
+        }
+
+        // How much of the table the kernel has put on huge pages, from the AnonHugePages of its mapping.
+        [[nodiscard]] std::size_t hugePageBytes() const
+        {
+            std::ifstream smaps("/proc/self/smaps");
+            const auto begin = reinterpret_cast<std::uintptr_t>(m_slots.get());
+            std::string line;
+            bool inside = false;
+            while (std::getline(smaps, line))
+            {
+                std::uintptr_t low = 0, high = 0;
+                char dash = 0;
+                std::istringstream fields(line);
+                if (fields >> std::hex >> low >> dash >> high && dash == '-') inside = low <= begin && begin < high;
+                else if (inside && line.starts_with("AnonHugePages:"))
+                {
+                    std::size_t kilobytes = 0;
+                    std::istringstream(line.substr(14)) >> kilobytes;
+                    return std::min(kilobytes * 1024, bytes());
+                }
+            }
+            return 0;
+        }
+
+        // move (16) | score (16) | depth (8) | bound (8)
+        [[nodiscard]] static constexpr std::uint64_t pack(chess::Move move, score_t score, int depth, Bound bound) noexcept
+        {
+            return std::uint64_t(move.data()) | (std::uint64_t(std::uint16_t(score)) << 16) | (std::uint64_t(std::uint8_t(depth)) << 32) |
+                   (std::uint64_t(std::to_underlying(bound)) << 40);
+        }
+
+        [[nodiscard]] static constexpr TableEntry unpack(std::uint64_t data) noexcept
+        {
+            return {chess::Move::fromData(std::uint16_t(data)), std::int16_t(data >> 16), std::uint8_t(data >> 32), Bound(std::uint8_t(data >> 40))};
+        }
+
+    public:
+        explicit TranspositionTable(std::size_t megabytes = 16) : m_slots(), m_mask(0), m_hugePages(false) { resize(megabytes); }
+
+        // Rounds down to a power of two slots so indexing is a mask.
+        void resize(std::size_t megabytes)
+        {
+            const auto count = std::bit_floor(std::max<std::size_t>(1, megabytes * 1024 * 1024 / sizeof(Slot)));
+            const auto size = count * sizeof(Slot);
+            m_slots.reset(); // Before the new one, so the two are never both held.
+
+            // A power of two, so a multiple of the huge page size whenever it is at least one.
+            void *memory = nullptr;
+            m_hugePages = false;
+            if (size >= s_hugePage)
+            {
+                memory = std::aligned_alloc(s_hugePage, size);
+#ifdef __linux__
+                m_hugePages = memory && madvise(memory, size, MADV_HUGEPAGE) == 0;
+#endif
+            }
+            if (!memory) memory = std::malloc(size);
+            if (!memory) throw std::bad_alloc();
+
+            m_slots.reset(static_cast<Slot *>(memory));
+            m_mask = count - 1;
+            forEachPart([this](std::size_t begin, std::size_t end) { std::uninitialized_default_construct(m_slots.get() + begin, m_slots.get() + end); });
+        }
+
+        void clear()
+        {
+            forEachPart([this](std::size_t begin, std::size_t end)
+            {
+                for (auto i = begin; i < end; i++)
+                {
+                    m_slots[i].check.store(0, std::memory_order_relaxed);
+                    m_slots[i].data.store(0, std::memory_order_relaxed);
+                }
+            });
+        }
+
+        [[nodiscard]] std::size_t bytes() const noexcept { return (m_mask + 1) * sizeof(Slot); }
+
+        // One line on what backs the table, for the log at start-up: the transparent huge page mode, how much of the
+        // table got huge pages, the TLB entries it takes to cover, and the NUMA nodes it is spread over.
+        [[nodiscard]] std::string memoryStatus() const
+        {
+            std::ifstream modes("/sys/kernel/mm/transparent_hugepage/enabled");
+            std::string mode = "unavailable";
+            if (std::string line; std::getline(modes, line) && line.find('[') != std::string::npos)
+                mode = line.substr(line.find('[') + 1, line.find(']') - line.find('[') - 1);
+
+            const auto huge = hugePageBytes();
+            const auto pages = huge / s_hugePage + (bytes() - huge + 4095) / 4096;
+            const auto nodes = Topology::system().nodes();
+            std::ostringstream out;
+            out << "hash " << bytes() / (1024 * 1024) << " MB, transparent huge pages " << mode << (m_hugePages ? "" : " (not advised)")
+                << ", " << huge / (1024 * 1024) << " MB on huge pages, " << pages << " TLB entries to cover (" << (bytes() + 4095) / 4096
+                << " on 4 KB pages), " << nodes << " NUMA node" << (nodes == 1 ? "" : "s");
+            return out.str();
+        }
+
+        // Mate scores are stored relative to the node, not the root, so they stay right wherever the position recurs.
+        [[nodiscard]] bool probe(chess::zobrist_t key, int ply, TableEntry &entry) const noexcept
+        {
+            const auto &slot = m_slots[key & m_mask];
+            const auto data = slot.data.load(std::memory_order_relaxed);
+            if ((slot.check.load(std::memory_order_relaxed) ^ data) != key) return false;
+
+            entry = unpack(data);
+            if (entry.score > MateBound) entry.score -= ply;
+            else if (entry.score < -MateBound) entry.score += ply;
+            return true;
+        }
+
+        void store(chess::zobrist_t key, int ply, chess::Move move, score_t score, int depth, Bound bound) noexcept
+        {
+            auto &slot = m_slots[key & m_mask];
+            const auto oldData = slot.data.load(std::memory_order_relaxed);
+            if ((slot.check.load(std::memory_order_relaxed) ^ oldData) == key)
+            {
+                // Same position: keep a deeper result unless this one is exact, and never forget the best move.
+                const auto old = unpack(oldData);
+                if (old.depth > depth && bound != Bound::Exact) return;
+                if (move.isNull()) move = old.move;
+            }
+
+            if (score > MateBound) score += ply;
+            else if (score < -MateBound) score -= ply;
+
+            const auto data = pack(move, score, depth, bound);
+            slot.check.store(key ^ data, std::memory_order_relaxed);
+            slot.data.store(data, std::memory_order_relaxed);
+        }
+    };
+} // namespace engine
+
+#endif // CHESS_ENGINE_TRANSPOSITION_TABLE_H
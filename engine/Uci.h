@@ -0,0 +1,335 @@
+#ifndef CHESS_ENGINE_UCI_H
+#define CHESS_ENGINE_UCI_H
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Counters.h"
+#include "Score.h"
+#include "Search.h"
+#include "Tracer.h"
+#include "TranspositionTable.h"
+#include "chess/Board.hpp"
+#include "chess/Move.h"
+#include "config.h"
+
+namespace engine
+{
+    // Plays a move given in UCI notation if it is legal in the position, keeping the board's history for repetitions.
+    // A malformed token is rejected as such rather than read as whatever squares its characters happen to map to.
+    inline bool playUci(chess::Board &board, std::string_view uciMove)
+    {
+        const auto move = board.parse(uciMove);
+        if (move.isNull() || !board.isLegal(move)) return false;
+
+        chess::Board::Undo undo;
+        return board.make(move, undo);
+    }
+
+    inline std::string uciScore(score_t score)
+    {
+        if (score > MateBound) return "mate " + std::to_string((MateScore - score + 1) / 2);
+        if (score < -MateBound) return "mate " + std::to_string(-(MateScore + score) / 2);
+        return "cp " + std::to_string(score);
+    }
+
+    constexpr const std::string_view StartingFen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+    // The rest of a "position" command: "startpos" or "fen <fen>", then optionally "moves" and the moves to play.
+    // Stops at the first illegal move.
+    inline chess::Board parsePosition(std::istream &in)
+    {
+        std::string token;
+        in >> token;
+        std::string fen(StartingFen);
+        if (token == "fen")
+        {
+            fen.clear();
+            while (in >> token && token != "moves")
+                fen += token + ' ';
+        }
+        else in >> token; // "moves", if any.
+
+        chess::Board board(fen);
+        while (in >> token)
+            if (!playUci(board, token)) break;
+        return board;
+    }
+
+    // The rest of a "go" command, for the side to move. Tokens it does not know are skipped; a known one without a
+    // number after it is an error rather than a search left without that limit.
+    inline Limits parseLimits(std::istream &in, chess::Color turn)
+    {
+        Limits limits;
+        long long time = -1, increment = 0, movesToGo = 30, ms = 0;
+        std::string token;
+        const auto value = [&](auto &out)
+        {
+            if (!(in >> out)) throw std::runtime_error("invalid value for " + token);
+        };
+        while (in >> token)
+        {
+            const bool white = turn == chess::Color::White;
+            if (token == "depth") value(limits.depth);
+            else if (token == "nodes") value(limits.nodes);
+            else if (token == "movetime")
+            {
+                value(ms);
+                limits.time = std::chrono::milliseconds(ms);
+            }
+            else if (token == (white ? "wtime" : "btime")) value(time);
+            else if (token == (white ? "winc" : "binc")) value(increment);
+            else if (token == "movestogo") value(movesToGo);
+            else if (token == "ponder") limits.ponder = true;
+            else if (token == "infinite") limits.infinite = true;
+        }
+
+        if (time >= 0 && limits.time.count() == 0)
+            limits.time = Limits::forClock(std::chrono::milliseconds(time), std::chrono::milliseconds(increment), static_cast<int>(movesToGo));
+        return limits;
+    }
+
+    // One info line per principal variation; multipv is only named when more than one line was asked for.
+    inline std::vector<std::string> infoLines(const Info &iteration, bool numbered)
+    {
+        std::vector<std::string> lines;
+        for (std::size_t i = 0; i < iteration.lines.size(); i++)
+        {
+            std::ostringstream line;
+            line << "info depth " << iteration.depth;
+            if (numbered) line << " multipv " << i + 1;
+            line << " score " << uciScore(iteration.lines[i].score) << " nodes " << iteration.nodes << " nps "
+                 << static_cast<std::uint64_t>(iteration.seconds > 0 ? double(iteration.nodes) / iteration.seconds : 0) << " time "
+                 << static_cast<std::uint64_t>(iteration.seconds * 1000) << " pv";
+            for (const auto move: iteration.lines[i].pv)
+                line << ' ' << move.uci();
+            lines.push_back(line.str());
+        }
+        return lines;
+    }
+
+    // The second move of the line is what to ponder on while the opponent thinks.
+    inline std::string bestMoveLine(const Info &info)
+    {
+        std::string line = "bestmove " + (info.pv.empty() ? chess::Move().uci() : info.pv.front().uci());
+        if (info.pv.size() > 1) line += " ponder " + info.pv[1].uci();
+        return line;
+    }
+
+    // The Universal Chess Interface over a pair of streams. Searches run on the search's own threads so "stop",
+    // "ponderhit" and "quit" are read while they think; output from all threads is serialised by one mutex.
+    // Table, move-ordering history and threads all stay warm from one "go" to the next.
+    class Uci
+    {
+        std::ostream &m_out;
+        std::mutex m_outMutex;
+        TranspositionTable m_table;
+        Search m_search;
+        chess::Board m_board;
+        unsigned m_threads;
+        std::unique_ptr<Tracer> m_tracer;
+
+        void send(const std::string &line)
+        {
+            const std::scoped_lock lock(m_outMutex);
+            m_out << line << std::endl;
+        }
+
+        void wait() { (void) m_search.wait(); }
+
+        void go(std::istringstream &in)
+        {
+            m_search.start(m_board, parseLimits(in, m_board.turn()), m_threads, [this](const Info &iteration) { report(iteration); },
+                           [this](const Info &info) { finished(info); });
+        }
+
+        void report(const Info &iteration)
+        {
+            for (const auto &line: infoLines(iteration, m_search.options().multiPv > 1))
+                send(line);
+        }
+
+        void finished(const Info &info)
+        {
+            if (m_tracer && !m_tracer->path().empty())
+            {
+                try
+                {
+                    m_tracer->flush(m_tracer->path());
+                }
+                catch (const std::runtime_error &error)
+                {
+                    send(std::string("info string ") + error.what());
+                }
+            }
+
+            if constexpr (Counters::enabled()) send("info string " + m_search.statistics().summary());
+
+            send(bestMoveLine(info));
+        }
+
+        void setOption(std::istringstream &in)
+        {
+            std::string token, name, value;
+            in >> token >> name >> token >> value; // name <id> value <x>
+            // Numbers are parsed as Options::set does and held to the ranges "uci" advertises; a bad one changes nothing.
+            long long number = 0;
+            const bool numeric = std::from_chars(value.data(), value.data() + value.size(), number).ec == std::errc();
+            if (name == "Hash")
+            {
+                if (!numeric) return;
+                const auto previous = m_table.bytes() >> 20;
+                try
+                {
+                    m_table.resize(static_cast<std::size_t>(std::clamp(number, 1LL, 65536LL)));
+                }
+                catch (const std::bad_alloc &)
+                {
+                    m_table.resize(previous); // The old table is already freed, so its size fits again.
+                    send("info string not enough memory for Hash " + value);
+                }
+                send("info string " + m_table.memoryStatus());
+            }
+            else if (name == "PinThreads") m_search.setPinning(value == "true");
+            else if (name == "Threads")
+            {
+                if (numeric) m_threads = static_cast<unsigned>(std::clamp(number, 1LL, 256LL));
+            }
+            else if (name == "Trace")
+            {
+                m_tracer = value == "true" ? std::make_unique<Tracer>() : nullptr;
+                m_search.setTracer(m_tracer.get());
+            }
+            else if (name == "TraceFile")
+            {
+                // Traces every search to the file; an empty value stops tracing.
+                m_tracer = value.empty() || value == "<empty>" ? nullptr : std::make_unique<Tracer>(1 << 20, value);
+                m_search.setTracer(m_tracer.get());
+            }
+            else
+            {
+                auto options = m_search.options();
+                if (options.set(name, value)) m_search.setOptions(options);
+            }
+        }
+
+    public:
+        explicit Uci(std::ostream &out)
+                : m_out(out), m_outMutex(), m_table(16), m_search(m_table), m_board(std::string(StartingFen)), m_threads(1), m_tracer() {}
+
+        ~Uci()
+        {
+            m_search.stop();
+            wait();
+        }
+
+        Uci(const Uci &) = delete;
+
+        Uci &operator=(const Uci &) = delete;
+
+        void loop(std::istream &in)
+        {
+            std::string line;
+            while (std::getline(in, line))
+            {
+                std::istringstream tokens(line);
+                std::string command;
+                tokens >> command;
+
+                if (command == "uci")
+                {
+                    send("id name " NAME);
+                    send("id author Ziyad Sameh");
+                    send("option name Hash type spin default 16 min 1 max 65536");
+                    send("option name Threads type spin default 1 min 1 max 256");
+                    send("option name PinThreads type check default true");
+                    send("option name Ponder type check default false");
+                    send("option name Contempt type spin default 0 min -1000 max 1000");
+                    send("option name MultiPV type spin default 1 min 1 max 256");
+                    for (const auto name: {"NullMove", "LMR", "ReverseFutility", "Futility", "Razoring", "CheckExtensions"})
+                        send(std::string("option name ") + name + " type check default true");
+                    send("option name Trace type check default false");
+                    send("option name TraceFile type string default <empty>");
+                    send("info string " + m_table.memoryStatus());
+                    send("uciok");
+                }
+                else if (command == "isready") send("readyok");
+                else if (command == "ucinewgame")
+                {
+                    wait();
+                    m_table.clear();
+                    m_search.clear();
+                }
+                else if (command == "setoption")
+                {
+                    wait();
+                    setOption(tokens);
+                }
+                else if (command == "position")
+                {
+                    wait();
+                    try
+                    {
+                        m_board = parsePosition(tokens);
+                    }
+                    catch (const std::runtime_error &)
+                    {
+                        send("info string invalid position");
+                    }
+                }
+                else if (command == "go")
+                {
+                    wait();
+                    try
+                    {
+                        go(tokens);
+                    }
+                    catch (const std::runtime_error &error)
+                    {
+                        send(std::string("info string ") + error.what());
+                    }
+                }
+                else if (command == "stop") m_search.stop();
+                else if (command == "ponderhit") m_search.ponderhit();
+                else if (command == "stats")
+                {
+                    // Not part of UCI: the last search's counters as one JSON object.
+                    wait();
+                    send(m_search.statistics().json());
+                }
+                else if (command == "trace")
+                {
+                    // Not part of UCI: writes the last search's trace to the given file.
+                    std::string path;
+                    tokens >> path;
+                    wait();
+                    if (!m_tracer) send("info string tracing is off, set option Trace first");
+                    else
+                    {
+                        try
+                        {
+                            m_tracer->flush(path);
+                        }
+                        catch (const std::runtime_error &error)
+                        {
+                            send(std::string("info string ") + error.what());
+                        }
+                    }
+                }
+                else if (command == "quit") break;
+            }
+        }
+    };
+} // namespace engine
+
+#endif // CHESS_ENGINE_UCI_H
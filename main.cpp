@@ -1,15 +1,96 @@
 #include <iostream>
+#include <string>
+#include <string_view>
 
 #include "chess/Board.hpp"
+#include "engine/Bench.h"
+#include "engine/MateSolver.h"
+#include "engine/Perft.h"
+#include "engine/Server.h"
+#include "engine/Uci.h"
 
-int main()
+int main(int argc, char *argv[])
 {
+    if (argc > 1 && std::string_view(argv[1]) == "bench")
+    {
+        const int depth = argc > 2 ? std::stoi(argv[2]) : engine::DefaultBenchDepth;
+        const unsigned threads = argc > 3 ? static_cast<unsigned>(std::stoul(argv[3])) : 1;
+        engine::bench(depth, threads, std::cout);
+        return 0;
+    }
+
+    // perft <depth> [threads] [hash MB] [fen]
+    if (argc > 1 && std::string_view(argv[1]) == "perft")
+    {
+        const int depth = argc > 2 ? std::stoi(argv[2]) : 5;
+        const unsigned threads = argc > 3 ? static_cast<unsigned>(std::stoul(argv[3])) : 1;
+        const std::size_t megabytes = argc > 4 ? std::stoul(argv[4]) : 16;
+        std::string fen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+        if (argc > 5)
+        {
+            fen = argv[5];
+            for (int i = 6; i < argc; i++)
+                fen += std::string(" ") + argv[i];
+        }
+        (void) engine::perft(chess::Board(fen), depth, threads, megabytes, std::cout);
+        return 0;
+    }
+
+    // mate <moves> [fen]: without a FEN, one position per line of standard input, for validating puzzles in bulk.
+    // Answers "mate <n> <line>", "none" or "unknown" per position.
+    if (argc > 2 && std::string_view(argv[1]) == "mate")
+    {
+        const int moves = std::stoi(argv[2]);
+        engine::MateSolver solver(64, true, 10000000);
+        auto solve = [&](const std::string &fen)
+        {
+            const auto result = solver.solve(chess::Board(fen), moves);
+            if (result.proof == search::Proof::Proven)
+            {
+                std::cout << "mate " << result.moves;
+                for (const auto move: result.line)
+                    std::cout << ' ' << move.uci();
+                std::cout << '\n';
+            }
+            else std::cout << (result.proof == search::Proof::Disproven ? "none\n" : "unknown\n");
+        };
+
+        if (argc > 3)
+        {
+            std::string fen = argv[3];
+            for (int i = 4; i < argc; i++)
+                fen += std::string(" ") + argv[i];
+            solve(fen);
+        }
+        else
+            for (std::string fen; std::getline(std::cin, fen);)
+                if (!fen.empty()) solve(fen);
+        return 0;
+    }
+
+    // server <socket path> [workers] [hash MB]
+    if (argc > 2 && std::string_view(argv[1]) == "server")
+    {
+        const unsigned workers = argc > 3 ? static_cast<unsigned>(std::stoul(argv[3])) : std::max(1u, std::thread::hardware_concurrency());
+        const std::size_t megabytes = argc > 4 ? std::stoul(argv[4]) : 64;
+        engine::Server server(argv[2], workers, megabytes);
+        server.run();
+        return 0;
+    }
+
+    if (argc > 1 && std::string_view(argv[1]) == "uci")
+    {
+        engine::Uci uci(std::cout);
+        uci.loop(std::cin);
+        return 0;
+    }
+
     auto fen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
     auto board = chess::Board(fen);
 
     std::cout << fen << '\n' << board.fen() << '\n';
 
-    chess::Result moveResult;
+    chess::Result moveResult = chess::Result::LegalMove;
     while (!GameOver(moveResult))
     {
         std::cout << board.fen() << '\n' << board.display() << "\nEnter move: ";
@@ -0,0 +1,139 @@
+#ifndef CHESS_ENGINE_ASTAR_H
+#define CHESS_ENGINE_ASTAR_H
+
+#include <chrono>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "IndexedHeap.h"
+#include "NodeArena.h"
+#include "Problem.h"
+#include "Solution.h"
+#include "StateTable.h"
+
+namespace search
+{
+    // Best-first search ordered on f = g + weight * h, ties broken by insertion order like Node's own ordering.
+    // weight = 1 is plain A*, weight > 1 is weighted A*, whose solutions cost at most weight times the optimum.
+    // All memory (arena, open list, closed set, action buffer) is kept between calls and reset per search.
+    template<SearchProblem P, typename Hash = std::hash<typename P::state_type>>
+    class AStar
+    {
+        using State = typename P::state_type;
+        using Action = typename P::action_type;
+        using priority_t = std::pair<double, int>;
+
+        P &m_problem;
+        double m_weight;
+
+        NodeArena<State, Action> m_arena;
+        IndexedHeap<priority_t> m_open;
+        StateTable<State, Action, Hash> m_states;
+        std::vector<Action> m_actions;
+
+        [[nodiscard]] priority_t priority(node_index_t index) const noexcept
+        {
+            const auto &node = m_arena[index];
+            return {node.pathCost() + m_weight * node.heuristicCost(), node.insertionOrder()};
+        }
+
+        [[nodiscard]] std::size_t bytesReserved() const noexcept
+        {
+            return m_arena.bytesReserved() + m_open.bytesReserved() + m_states.bytesReserved() + m_actions.capacity() * sizeof(Action);
+        }
+
+    public:
+        explicit AStar(P &problem, double weight = 1.0, Hash hasher = Hash())
+                : m_problem(problem), m_weight(weight), m_arena(), m_open(), m_states(std::move(hasher)), m_actions() {}
+
+        Solution<Action> search()
+        {
+            const auto start = std::chrono::steady_clock::now();
+            m_arena.reset();
+            m_open.clear();
+            m_states.clear();
+
+            Solution<Action> solution;
+            auto &statistics = solution.statistics;
+
+            // Without a consistent heuristic a closed node may later be reached more cheaply. Plain A* reopens it to
+            // stay optimal; weighted A* keeps its bound without reopening and skips that work.
+            const bool reopen = m_weight <= 1.0;
+
+            auto initial = m_problem.initialState();
+            const auto rootHash = m_states.hash(initial);
+            const auto rootHeuristic = m_problem.heuristic(initial);
+            const auto root = m_arena.emplace(std::move(initial), rootHeuristic);
+            m_states.insert(rootHash, root);
+            m_open.push(root, priority(root));
+
+            int order = 1;
+            while (!m_open.empty())
+            {
+                const auto current = m_open.pop();
+                const auto &node = m_arena[current];
+                if (m_problem.isGoal(node.state()))
+                {
+                    solution.found = true;
+                    solution.path = node.backtrack(m_arena);
+                    solution.cost = node.pathCost();
+                    break;
+                }
+
+                statistics.expanded++;
+                m_actions.clear();
+                m_problem.actions(node.state(), std::back_inserter(m_actions));
+                for (const auto &action: m_actions)
+                {
+                    State child;
+                    m_problem.successor(node.state(), action, child);
+                    const double pathCost = node.pathCost() + m_problem.cost(node.state(), action);
+                    statistics.generated++;
+
+                    const auto hash = m_states.hash(child);
+                    const auto existing = m_states.find(m_arena, child, hash);
+                    if (existing == NoNode)
+                    {
+                        const double heuristic = m_problem.heuristic(child);
+                        const auto index = m_arena.emplace(std::move(child), action, current, pathCost, heuristic, order++);
+                        m_states.insert(hash, index);
+                        m_open.push(index, priority(index));
+                    }
+                    else if (pathCost < m_arena[existing].pathCost())
+                    {
+                        if (m_open.contains(existing))
+                        {
+                            m_arena[existing].relax(current, action, pathCost);
+                            m_open.decrease(existing, priority(existing));
+                        }
+                        else if (reopen)
+                        {
+                            m_arena[existing].relax(current, action, pathCost);
+                            m_open.push(existing, priority(existing));
+                        }
+                    }
+                }
+            }
+
+            statistics.peakMemory = bytesReserved();
+            statistics.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            return solution;
+        }
+    };
+
+    template<SearchProblem P, typename Hash = std::hash<typename P::state_type>>
+    Solution<typename P::action_type> aStar(P &problem, Hash hasher = Hash())
+    {
+        return AStar<P, Hash>(problem, 1.0, std::move(hasher)).search();
+    }
+
+    template<SearchProblem P, typename Hash = std::hash<typename P::state_type>>
+    Solution<typename P::action_type> weightedAStar(P &problem, double weight, Hash hasher = Hash())
+    {
+        return AStar<P, Hash>(problem, weight, std::move(hasher)).search();
+    }
+} // search
+
+#endif //CHESS_ENGINE_ASTAR_H
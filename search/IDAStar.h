@@ -0,0 +1,118 @@
+#ifndef CHESS_ENGINE_IDASTAR_H
+#define CHESS_ENGINE_IDASTAR_H
+
+#include <chrono>
+#include <deque>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+#include "Problem.h"
+#include "Solution.h"
+
+namespace search
+{
+    // Iterative-deepening A*: repeated depth-first searches bounded by f = g + h, each raising the bound to the smallest
+    // f that exceeded it. Memory is linear in the solution depth, one state and one action buffer per ply, all reused
+    // between iterations. Moves straight back to the grandparent state are pruned when states are comparable.
+    template<SearchProblem P>
+    class IDAStar
+    {
+        using State = typename P::state_type;
+        using Action = typename P::action_type;
+
+        // Stands in for infinity, which -Ofast lets the compiler assume never turns up.
+        static constexpr const double s_infinity = std::numeric_limits<double>::max();
+
+        P &m_problem;
+
+        // Deques, so growing them while deeper plies are searched never moves the shallower ones.
+        std::deque<State> m_states;
+        std::deque<std::vector<Action>> m_actions;
+        std::vector<Action> m_path;
+        Statistics m_statistics;
+
+        // True when a goal is found within bound, with m_path leading to it. Otherwise next is set to the least f
+        // that exceeded the bound, s_infinity if nothing did.
+        bool boundedSearch(std::size_t depth, double pathCost, double bound, double &next)
+        {
+            const auto &state = m_states[depth];
+            const double estimate = pathCost + m_problem.heuristic(state);
+            next = estimate;
+            if (estimate > bound) return false;
+            if (m_problem.isGoal(state)) return true;
+
+            if (m_actions.size() <= depth) m_actions.emplace_back();
+            if (m_states.size() <= depth + 1) m_states.emplace_back();
+
+            m_statistics.expanded++;
+            auto &actions = m_actions[depth];
+            actions.clear();
+            m_problem.actions(state, std::back_inserter(actions));
+
+            next = s_infinity;
+            for (const auto &action: actions)
+            {
+                auto &child = m_states[depth + 1];
+                m_problem.successor(state, action, child);
+                m_statistics.generated++;
+
+                if constexpr (std::equality_comparable<State>)
+                    if (depth > 0 && child == m_states[depth - 1])
+                        continue;
+
+                m_path.push_back(action);
+                double childNext = s_infinity;
+                if (boundedSearch(depth + 1, pathCost + m_problem.cost(state, action), bound, childNext)) return true;
+
+                m_path.pop_back();
+                if (childNext < next) next = childNext;
+            }
+            return false;
+        }
+
+    public:
+        explicit IDAStar(P &problem) : m_problem(problem), m_states(), m_actions(), m_path(), m_statistics() {}
+
+        Solution<Action> search()
+        {
+            const auto start = std::chrono::steady_clock::now();
+            m_statistics = Statistics();
+            m_path.clear();
+            if (m_states.empty()) m_states.emplace_back();
+            m_states.front() = m_problem.initialState();
+
+            Solution<Action> solution;
+            auto bound = m_problem.heuristic(m_states.front());
+            while (true)
+            {
+                double next = s_infinity;
+                if (boundedSearch(0, 0.0, bound, next))
+                {
+                    solution.found = true;
+                    solution.path = m_path;
+                    for (std::size_t i = 0; i < m_path.size(); i++)
+                        solution.cost += m_problem.cost(m_states[i], m_path[i]);
+                    break;
+                }
+                if (next >= s_infinity) break;
+                bound = next;
+            }
+
+            std::size_t actionBytes = 0;
+            for (const auto &actions: m_actions) actionBytes += actions.capacity() * sizeof(Action);
+            m_statistics.peakMemory = m_states.size() * sizeof(State) + actionBytes + m_path.capacity() * sizeof(Action);
+            m_statistics.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            solution.statistics = m_statistics;
+            return solution;
+        }
+    };
+
+    template<SearchProblem P>
+    Solution<typename P::action_type> idaStar(P &problem)
+    {
+        return IDAStar<P>(problem).search();
+    }
+} // search
+
+#endif //CHESS_ENGINE_IDASTAR_H
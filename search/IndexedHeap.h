@@ -0,0 +1,123 @@
+#ifndef CHESS_ENGINE_INDEXED_HEAP_H
+#define CHESS_ENGINE_INDEXED_HEAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "Node.h"
+
+namespace search
+{
+    // Binary min-heap of arena nodes. Each node remembers its slot in the heap, so a queued node's priority can be
+    // lowered in place (decrease-key) instead of queueing a duplicate. Priorities are stored next to the node index so
+    // sifting never touches the arena.
+    template<typename Priority>
+    class IndexedHeap
+    {
+        struct Entry
+        {
+            Priority priority;
+            node_index_t node;
+        };
+
+        static constexpr const std::uint32_t s_absent = ~std::uint32_t(0);
+
+        std::vector<Entry> m_entries;
+        std::vector<std::uint32_t> m_positions; // Indexed by node, s_absent when the node is not queued.
+
+        void place(std::size_t slot, Entry entry) noexcept
+        {
+            m_positions[entry.node] = static_cast<std::uint32_t>(slot);
+            m_entries[slot] = std::move(entry);
+        }
+
+        void siftUp(std::size_t slot) noexcept
+        {
+            Entry entry = std::move(m_entries[slot]);
+            while (slot > 0)
+            {
+                const auto parent = (slot - 1) / 2;
+                if (!(entry.priority < m_entries[parent].priority)) break;
+                place(slot, std::move(m_entries[parent]));
+                slot = parent;
+            }
+            place(slot, std::move(entry));
+        }
+
+        void siftDown(std::size_t slot) noexcept
+        {
+            Entry entry = std::move(m_entries[slot]);
+            const auto size = m_entries.size();
+            while (true)
+            {
+                auto child = 2 * slot + 1;
+                if (child >= size) break;
+                if (child + 1 < size && m_entries[child + 1].priority < m_entries[child].priority) child++;
+                if (!(m_entries[child].priority < entry.priority)) break;
+                place(slot, std::move(m_entries[child]));
+                slot = child;
+            }
+            place(slot, std::move(entry));
+        }
+
+    public:
+        IndexedHeap() : m_entries(), m_positions() {}
+
+        [[nodiscard]] bool empty() const noexcept { return m_entries.empty(); }
+
+        [[nodiscard]] std::size_t size() const noexcept { return m_entries.size(); }
+
+        [[nodiscard]] bool contains(node_index_t node) const noexcept
+        {
+            return node < m_positions.size() && m_positions[node] != s_absent;
+        }
+
+        [[nodiscard]] const Priority &topPriority() const noexcept { return m_entries.front().priority; }
+
+        void push(node_index_t node, Priority priority)
+        {
+            if (node >= m_positions.size()) m_positions.resize(std::size_t(node) + 1, s_absent);
+
+            m_entries.push_back({std::move(priority), node});
+            siftUp(m_entries.size() - 1);
+        }
+
+        // The new priority must not be greater than the current one.
+        void decrease(node_index_t node, Priority priority) noexcept
+        {
+            const auto slot = m_positions[node];
+            m_entries[slot].priority = std::move(priority);
+            siftUp(slot);
+        }
+
+        node_index_t pop() noexcept
+        {
+            const auto top = m_entries.front().node;
+            m_positions[top] = s_absent;
+
+            auto last = std::move(m_entries.back());
+            m_entries.pop_back();
+            if (!m_entries.empty())
+            {
+                m_entries.front() = std::move(last);
+                siftDown(0);
+            }
+            return top;
+        }
+
+        void clear() noexcept
+        {
+            m_entries.clear();
+            m_positions.clear();
+        }
+
+        [[nodiscard]] std::size_t bytesReserved() const noexcept
+        {
+            return m_entries.capacity() * sizeof(Entry) + m_positions.capacity() * sizeof(std::uint32_t);
+        }
+    };
+} // search
+
+#endif //CHESS_ENGINE_INDEXED_HEAP_H
@@ -0,0 +1,58 @@
+#ifndef CHESS_ENGINE_MPSC_QUEUE_H
+#define CHESS_ENGINE_MPSC_QUEUE_H
+
+#include <atomic>
+#include <utility>
+
+namespace search
+{
+    // Unbounded multi-producer single-consumer queue (Vyukov). Producers publish with a single atomic exchange and never
+    // wait on each other or on the consumer; the consumer owns the tail and needs no atomic read-modify-write at all.
+    // A push is visible to the consumer once its link is stored, a moment after the exchange.
+    template<typename T>
+    class MpscQueue
+    {
+        struct Link
+        {
+            std::atomic<Link *> next;
+            T value;
+        };
+
+        alignas(64) std::atomic<Link *> m_head;
+        alignas(64) Link *m_tail;
+
+    public:
+        MpscQueue() : m_head(new Link{nullptr, T()}), m_tail(m_head.load(std::memory_order_relaxed)) {}
+
+        MpscQueue(const MpscQueue &) = delete;
+        MpscQueue &operator=(const MpscQueue &) = delete;
+
+        ~MpscQueue()
+        {
+            T discarded;
+            while (pop(discarded)) {}
+            delete m_tail;
+        }
+
+        void push(T value)
+        {
+            auto *link = new Link{nullptr, std::move(value)};
+            auto *previous = m_head.exchange(link, std::memory_order_acq_rel);
+            previous->next.store(link, std::memory_order_release);
+        }
+
+        // Consumer only.
+        bool pop(T &out)
+        {
+            auto *next = m_tail->next.load(std::memory_order_acquire);
+            if (next == nullptr) return false;
+
+            out = std::move(next->value);
+            delete m_tail;
+            m_tail = next;
+            return true;
+        }
+    };
+} // search
+
+#endif //CHESS_ENGINE_MPSC_QUEUE_H
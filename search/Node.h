@@ -1,84 +1,95 @@
 #ifndef CHESS_ENGINE_NODE_H
 #define CHESS_ENGINE_NODE_H
 
+#include <cstdint>
+#include <utility>
+#include <vector>
+
 #include "Problem.h"
 
 namespace search
 {
+    using node_index_t = std::uint32_t;
+
+    constexpr const node_index_t NoNode = ~node_index_t(0);
+    constexpr const node_index_t NoParent = NoNode;
+
+    template<typename State, typename Action>
+    class NodeArena;
+
     template<typename State, typename Action>
     class Node
     {
-        State *m_state;
+        State m_state;
 
-        std::vector<Action *> m_path;
-        // O(1) backtracking at cost of memory, can be reversed by using commented lines below instead
-        // (along with similar changes in 'child_node' and 'backtrack' functions below)
-        //Node *parent;
-        //Action *action;
+        // Only the incoming action and the parent are stored, the path is rebuilt on demand by 'backtrack'.
+        // Nodes live in a NodeArena, so the parent is an index into it rather than a pointer.
+        Action m_action;
+        node_index_t m_parent;
 
+        int m_insertionOrder;
         double m_pathCost;
         double m_heuristicCost;
-        int m_insertionOrder;
-
-        constexpr Node(const State *state, const std::vector<Action *> &path, double pathCost, double heuristicCost, int insertionOrder)
-                : m_state(state), m_path(path), m_pathCost(pathCost), m_heuristicCost(heuristicCost), m_insertionOrder(insertionOrder) {}
 
     public:
-        explicit constexpr Node(const State &state) : m_state(&state), m_pathCost(0.0), m_heuristicCost(0.0), m_insertionOrder(0) {}
+        constexpr Node(State state, const Action &action, node_index_t parent, double pathCost, double heuristicCost, int insertionOrder)
+                : m_state(std::move(state)), m_action(action), m_parent(parent), m_insertionOrder(insertionOrder), m_pathCost(pathCost),
+                  m_heuristicCost(heuristicCost) {}
+
+        explicit constexpr Node(State state, double heuristicCost = 0.0)
+                : m_state(std::move(state)), m_action(), m_parent(NoParent), m_insertionOrder(0), m_pathCost(0.0),
+                  m_heuristicCost(heuristicCost) {}
+
+        [[nodiscard]] constexpr const State &state() const noexcept { return m_state; }
+
+        [[nodiscard]] constexpr const Action &action() const noexcept { return m_action; }
+
+        [[nodiscard]] constexpr node_index_t parent() const noexcept { return m_parent; }
 
+        [[nodiscard]] constexpr double pathCost() const noexcept { return m_pathCost; }
+
+        [[nodiscard]] constexpr double heuristicCost() const noexcept { return m_heuristicCost; }
+
+        [[nodiscard]] constexpr int insertionOrder() const noexcept { return m_insertionOrder; }
+
+        // A cheaper path to this node's state was found: adopt it, keeping the heuristic estimate.
+        constexpr void relax(node_index_t parent, const Action &action, double pathCost)
+        {
+            m_parent = parent;
+            m_action = action;
+            m_pathCost = pathCost;
+        }
+
+        // Ordered on f, then insertion order. Equal f is what neither f is less than, so costs are never tested
+        // for equality.
         constexpr bool operator<(const Node<State, Action> &other) const
         {
-            if (this->heuristicCost + this->pathCost == other.heuristicCost + other.pathCost)
-                return this->insertionOrder < other.insertionOrder;
-            return this->heuristicCost + this->pathCost < other.heuristicCost + other.pathCost;
+            const auto f = m_heuristicCost + m_pathCost, otherF = other.m_heuristicCost + other.m_pathCost;
+            if (f < otherF || otherF < f) return f < otherF;
+            return m_insertionOrder < other.m_insertionOrder;
         }
 
         constexpr bool operator<=(const Node<State, Action> &other) const
         {
-            if (this->heuristicCost + this->pathCost == other.heuristicCost + other.pathCost)
-                return this->insertionOrder <= other.insertionOrder;
-            return this->heuristicCost + this->pathCost < other.heuristicCost + other.pathCost;
+            const auto f = m_heuristicCost + m_pathCost, otherF = other.m_heuristicCost + other.m_pathCost;
+            if (f < otherF || otherF < f) return f < otherF;
+            return m_insertionOrder <= other.m_insertionOrder;
         }
 
         constexpr bool operator>(const Node<State, Action> &other) const { return other < *this; }
 
         constexpr bool operator>=(const Node<State, Action> &other) const { return other <= *this; }
 
-        constexpr std::vector<Action *> backtrack() const
+        // O(depth), only paid once for the goal node instead of copying the path into every child.
+        std::vector<Action> backtrack(const NodeArena<State, Action> &arena) const
         {
-            return this->path;
-            // O(1) backtracking at cost of memory, can be reversed by using commented lines below instead
-            // (along with similar changes in 'child_node' function and 'Node' class above)
-
-            //std::vector<Action *> path;
-            //Node<State, Action> *node = this;
-            //while (node != nullptr)
-            //{
-            //    path.insert(path.begin(), node->action);
-            //    node = node->parent;
-            //}
-            //return path;
-        }
+            std::vector<Action> path;
+            for (const auto *node = this; node->m_parent != NoParent; node = &arena[node->m_parent])
+                path.push_back(node->m_action);
 
-        constexpr Node<State, Action> *child(const Problem<State, Action> &problem, const Action *action, int order) const
-        {
-            State *childState = problem.successor(*this->state, action);
-            std::vector<Action *> childPath = this->path;
-            childPath.push_back(&action);
-            double childPathCost = this->pathCost + problem.cost(this->state, action);
-            double childHeuristicCost = problem.heuristic(childState);
-            return new Node<State, Action>(childState, childPath, childPathCost, childHeuristicCost, order);
+            return {path.rbegin(), path.rend()};
         }
     };
 } // search
 
-template<typename State, typename Action>
-struct std::hash<search::Node<State, Action>>
-{
-    size_t operator()(const search::Node<State, Action> &node) const
-    {
-        return hash<State>()(node.state);
-    }
-};
-
 #endif //CHESS_ENGINE_NODE_H
@@ -0,0 +1,88 @@
+#ifndef CHESS_ENGINE_NODE_ARENA_H
+#define CHESS_ENGINE_NODE_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Node.h"
+
+namespace search
+{
+    // Slab allocator for the nodes of one search. Nodes are appended into fixed-size blocks, so they never move and
+    // growing never copies, and are all released at once by 'reset' (which keeps the blocks for the next search).
+    template<typename State, typename Action>
+    class NodeArena
+    {
+        using node_t = Node<State, Action>;
+
+        static constexpr const std::size_t s_blockShift = 12;
+        static constexpr const std::size_t s_blockSize = std::size_t(1) << s_blockShift;
+
+        struct Block
+        {
+            alignas(node_t) std::byte storage[sizeof(node_t) * s_blockSize];
+        };
+
+        std::vector<std::unique_ptr<Block>> m_blocks;
+        node_index_t m_size;
+
+        [[nodiscard]] node_t *slot(node_index_t index) const noexcept
+        {
+            auto *storage = m_blocks[index >> s_blockShift]->storage;
+            return std::launder(reinterpret_cast<node_t *>(storage) + (index & (s_blockSize - 1)));
+        }
+
+    public:
+        NodeArena() : m_blocks(), m_size(0) {}
+
+        NodeArena(const NodeArena &) = delete;
+        NodeArena &operator=(const NodeArena &) = delete;
+
+        ~NodeArena() { reset(); }
+
+        template<typename... Args>
+        node_index_t emplace(Args &&... args)
+        {
+            if ((m_size >> s_blockShift) == m_blocks.size())
+                m_blocks.push_back(std::make_unique<Block>());
+
+            ::new(static_cast<void *>(slot(m_size))) node_t(std::forward<Args>(args)...);
+            return m_size++;
+        }
+
+        // Expands 'parent' by 'action'. Only the parent's index and the action are recorded, the path stays implicit.
+        template<SearchProblem P>
+        node_index_t child(P &problem, node_index_t parent, const Action &action, int order)
+        {
+            const auto &node = (*this)[parent];
+            State childState;
+            problem.successor(node.state(), action, childState);
+            const double childPathCost = node.pathCost() + problem.cost(node.state(), action);
+            const double childHeuristicCost = problem.heuristic(childState);
+            return emplace(std::move(childState), action, parent, childPathCost, childHeuristicCost, order);
+        }
+
+        [[nodiscard]] const node_t &operator[](node_index_t index) const noexcept { return *slot(index); }
+
+        [[nodiscard]] node_t &operator[](node_index_t index) noexcept { return *slot(index); }
+
+        [[nodiscard]] node_index_t size() const noexcept { return m_size; }
+
+        [[nodiscard]] std::size_t bytesReserved() const noexcept { return m_blocks.size() * sizeof(Block); }
+
+        void reset() noexcept
+        {
+            if constexpr (!std::is_trivially_destructible_v<node_t>)
+                for (node_index_t i = 0; i < m_size; i++)
+                    slot(i)->~node_t();
+
+            m_size = 0;
+        }
+    };
+} // search
+
+#endif //CHESS_ENGINE_NODE_ARENA_H
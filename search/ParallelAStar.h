@@ -0,0 +1,281 @@
+#ifndef CHESS_ENGINE_PARALLEL_ASTAR_H
+#define CHESS_ENGINE_PARALLEL_ASTAR_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "IndexedHeap.h"
+#include "MpscQueue.h"
+#include "NodeArena.h"
+#include "Problem.h"
+#include "Solution.h"
+#include "StateTable.h"
+
+namespace search
+{
+    // Hash-distributed A* (HDA*). Every state has one owner thread, chosen by its hash, which alone keeps it in its
+    // open list and closed set, so threads share no search structures and take no locks. A generated child owned by
+    // another thread is batched and sent to the owner's lock-free inbox.
+    //
+    // A goal only becomes the incumbent. Threads keep going, discarding anything whose f can no longer beat it, until
+    // the whole system runs dry. Termination uses one counter of outstanding work: busy threads plus batches in flight.
+    // Sending adds one before the push. A busy thread consuming a batch removes one. An idle thread consuming a batch
+    // takes over its unit and becomes busy. Going idle removes one. At zero no thread has work and nothing is in
+    // flight, so one atomic load decides termination.
+    //
+    // Problem calls happen concurrently from all threads, so they must be safe to make in parallel.
+    template<SearchProblem P, typename Hash = std::hash<typename P::state_type>>
+    class ParallelAStar
+    {
+        using State = typename P::state_type;
+        using Action = typename P::action_type;
+        using priority_t = std::pair<double, int>;
+
+        static constexpr const std::size_t s_batchSize = 64;
+        // No incumbent yet. Not infinity, which -Ofast lets the compiler assume never turns up.
+        static constexpr const double s_infinity = std::numeric_limits<double>::max();
+
+        struct Message
+        {
+            State state;
+            Action action;
+            double pathCost;
+            std::size_t hash;
+            node_index_t parent;
+            std::uint32_t parentOwner;
+        };
+
+        using batch_t = std::vector<Message>;
+
+        struct Worker
+        {
+            NodeArena<State, Action> arena{};
+            IndexedHeap<priority_t> open{};
+            StateTable<State, Action, Hash> states;
+            std::vector<std::uint32_t> parentOwners{}; // Parallel to the arena: which thread's arena holds the parent.
+            std::vector<Action> actions{};
+            std::vector<batch_t> outbox{};
+            MpscQueue<batch_t> inbox{};
+            Statistics statistics{};
+            int order = 0;
+
+            explicit Worker(const Hash &hasher) : states(hasher) {}
+        };
+
+        P &m_problem;
+        unsigned m_threadCount;
+        Hash m_hasher;
+        std::vector<std::unique_ptr<Worker>> m_workers;
+
+        alignas(64) std::atomic<std::int64_t> m_work;
+        alignas(64) std::atomic<double> m_incumbentCost;
+        std::mutex m_incumbentMutex;
+        std::uint32_t m_incumbentOwner;
+        node_index_t m_incumbentNode;
+
+        [[nodiscard]] std::uint32_t owner(std::size_t hash) const noexcept
+        {
+            // Mixed separately from the table's own slot selection, otherwise each thread's table would only ever see
+            // hashes sharing the same low bits.
+            return static_cast<std::uint32_t>(((hash * 0x9E3779B97F4A7C15) >> 32) % m_threadCount);
+        }
+
+        [[nodiscard]] static priority_t priority(const Worker &worker, node_index_t index) noexcept
+        {
+            const auto &node = worker.arena[index];
+            return {node.pathCost() + node.heuristicCost(), node.insertionOrder()};
+        }
+
+        void receive(Worker &worker, Message &message)
+        {
+            const auto existing = worker.states.find(worker.arena, message.state, message.hash);
+            if (existing == NoNode)
+            {
+                const double heuristic = m_problem.heuristic(message.state);
+                if (message.pathCost + heuristic >= m_incumbentCost.load(std::memory_order_relaxed)) return;
+
+                const auto index = worker.arena.emplace(std::move(message.state), message.action, message.parent, message.pathCost,
+                                                        heuristic, worker.order++);
+                worker.parentOwners.push_back(message.parentOwner);
+                worker.states.insert(message.hash, index);
+                worker.open.push(index, priority(worker, index));
+            }
+            else if (message.pathCost < worker.arena[existing].pathCost())
+            {
+                // Another thread may have expanded this state along a worse path first, so closed nodes are reopened.
+                worker.arena[existing].relax(message.parent, message.action, message.pathCost);
+                worker.parentOwners[existing] = message.parentOwner;
+                if (worker.open.contains(existing)) worker.open.decrease(existing, priority(worker, existing));
+                else worker.open.push(existing, priority(worker, existing));
+            }
+        }
+
+        void flush(Worker &worker, std::uint32_t destination)
+        {
+            auto &batch = worker.outbox[destination];
+            if (batch.empty()) return;
+
+            m_work.fetch_add(1, std::memory_order_acq_rel);
+            m_workers[destination]->inbox.push(std::move(batch));
+            batch = batch_t();
+            batch.reserve(s_batchSize);
+        }
+
+        void expand(Worker &worker, std::uint32_t self, node_index_t current)
+        {
+            const auto &node = worker.arena[current];
+            if (node.pathCost() + node.heuristicCost() >= m_incumbentCost.load(std::memory_order_relaxed)) return;
+
+            if (m_problem.isGoal(node.state()))
+            {
+                const std::scoped_lock lock(m_incumbentMutex);
+                if (node.pathCost() < m_incumbentCost.load(std::memory_order_relaxed))
+                {
+                    m_incumbentOwner = self;
+                    m_incumbentNode = current;
+                    m_incumbentCost.store(node.pathCost(), std::memory_order_relaxed);
+                }
+                return;
+            }
+
+            worker.statistics.expanded++;
+            worker.actions.clear();
+            m_problem.actions(node.state(), std::back_inserter(worker.actions));
+            for (const auto &action: worker.actions)
+            {
+                Message message{State(), action, node.pathCost() + m_problem.cost(node.state(), action), 0, current, self};
+                m_problem.successor(node.state(), action, message.state);
+                message.hash = worker.states.hash(message.state);
+                worker.statistics.generated++;
+
+                const auto destination = owner(message.hash);
+                if (destination == self)
+                {
+                    receive(worker, message);
+                    continue;
+                }
+
+                worker.outbox[destination].push_back(std::move(message));
+                if (worker.outbox[destination].size() >= s_batchSize) flush(worker, destination);
+            }
+        }
+
+        void run(std::uint32_t self)
+        {
+            auto &worker = *m_workers[self];
+            bool busy = true;
+            batch_t batch;
+            while (true)
+            {
+                while (worker.inbox.pop(batch))
+                {
+                    if (busy) m_work.fetch_sub(1, std::memory_order_acq_rel);
+                    busy = true;
+                    for (auto &message: batch) receive(worker, message);
+                }
+
+                if (!worker.open.empty())
+                {
+                    expand(worker, self, worker.open.pop());
+                    continue;
+                }
+
+                for (std::uint32_t destination = 0; destination < m_threadCount; destination++)
+                    flush(worker, destination);
+
+                if (busy)
+                {
+                    busy = false;
+                    m_work.fetch_sub(1, std::memory_order_acq_rel);
+                }
+                if (m_work.load(std::memory_order_acquire) == 0) break;
+                std::this_thread::yield();
+            }
+        }
+
+    public:
+        explicit ParallelAStar(P &problem, unsigned threads = std::max(1u, std::thread::hardware_concurrency()), Hash hasher = Hash())
+                : m_problem(problem), m_threadCount(std::max(1u, threads)), m_hasher(std::move(hasher)), m_workers(), m_work(0),
+                  m_incumbentCost(s_infinity), m_incumbentMutex(), m_incumbentOwner(0), m_incumbentNode(NoNode)
+        {
+            for (unsigned i = 0; i < m_threadCount; i++)
+            {
+                m_workers.push_back(std::make_unique<Worker>(m_hasher));
+                m_workers.back()->outbox.resize(m_threadCount);
+            }
+        }
+
+        Solution<Action> search()
+        {
+            const auto start = std::chrono::steady_clock::now();
+            for (auto &worker: m_workers)
+            {
+                worker->arena.reset();
+                worker->open.clear();
+                worker->states.clear();
+                worker->parentOwners.clear();
+                worker->statistics = Statistics();
+                worker->order = 0;
+            }
+            m_incumbentCost.store(s_infinity);
+            m_incumbentNode = NoNode;
+
+            Message root{m_problem.initialState(), Action(), 0.0, 0, NoParent, 0};
+            root.hash = m_hasher(root.state);
+            receive(*m_workers[owner(root.hash)], root);
+
+            m_work.store(m_threadCount);
+            {
+                std::vector<std::jthread> threads;
+                for (std::uint32_t i = 0; i < m_threadCount; i++)
+                    threads.emplace_back([this, i] { run(i); });
+            }
+
+            Solution<Action> solution;
+            if (m_incumbentNode != NoNode)
+            {
+                solution.found = true;
+                solution.cost = m_incumbentCost.load();
+                auto ownerIndex = m_incumbentOwner;
+                for (auto index = m_incumbentNode; m_workers[ownerIndex]->arena[index].parent() != NoParent;)
+                {
+                    const auto &node = m_workers[ownerIndex]->arena[index];
+                    solution.path.push_back(node.action());
+                    const auto parentOwner = m_workers[ownerIndex]->parentOwners[index];
+                    index = node.parent();
+                    ownerIndex = parentOwner;
+                }
+                std::reverse(solution.path.begin(), solution.path.end());
+            }
+
+            auto &statistics = solution.statistics;
+            for (const auto &worker: m_workers)
+            {
+                statistics.expanded += worker->statistics.expanded;
+                statistics.generated += worker->statistics.generated;
+                statistics.peakMemory += worker->arena.bytesReserved() + worker->open.bytesReserved() + worker->states.bytesReserved() +
+                                         worker->parentOwners.capacity() * sizeof(std::uint32_t);
+            }
+            statistics.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            return solution;
+        }
+    };
+
+    template<SearchProblem P, typename Hash = std::hash<typename P::state_type>>
+    Solution<typename P::action_type> parallelAStar(P &problem, unsigned threads, Hash hasher = Hash())
+    {
+        return ParallelAStar<P, Hash>(problem, threads, std::move(hasher)).search();
+    }
+} // search
+
+#endif //CHESS_ENGINE_PARALLEL_ASTAR_H
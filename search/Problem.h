@@ -1,28 +1,81 @@
 #ifndef CHESS_ENGINE_PROBLEM_H
 #define CHESS_ENGINE_PROBLEM_H
 
+#include <concepts>
+#include <iterator>
+#include <utility>
 #include <vector>
 
 namespace search
 {
+    template<typename Action>
+    using action_sink_t = std::back_insert_iterator<std::vector<Action>>;
+
+    // Compile-time interface of a search problem. Searches are templated on it, so successor, cost and heuristic
+    // calls inline into the search loop. Actions are appended to a buffer the search reuses and successors are written
+    // into storage the search owns, so neither allocates per expansion.
+    template<typename P>
+    concept SearchProblem = std::copyable<typename P::state_type> && std::default_initializable<typename P::state_type> &&
+                            std::copyable<typename P::action_type> && std::default_initializable<typename P::action_type> &&
+                            requires(P &problem, const typename P::state_type &state, const typename P::action_type &action,
+                                     typename P::state_type &successor, action_sink_t<typename P::action_type> actions)
+                            {
+                                { problem.initialState() } -> std::convertible_to<typename P::state_type>;
+                                { problem.isGoal(state) } -> std::convertible_to<bool>;
+                                problem.actions(state, actions);
+                                problem.successor(state, action, successor);
+                                { problem.cost(state, action) } -> std::convertible_to<double>;
+                                { problem.heuristic(state) } -> std::convertible_to<double>;
+                            };
+
+    // Runtime-polymorphic form of the same interface, for callers that pick the problem at runtime.
+    // It satisfies SearchProblem itself, so every search accepts it, paying a virtual call per operation.
     template<typename State, typename Action>
     class Problem
     {
     public:
+        using state_type = State;
+        using action_type = Action;
+
         virtual State initialState() = 0;
 
-        virtual bool isGoal(const State *state) = 0;
+        virtual bool isGoal(const State &state) = 0;
 
-        virtual std::vector<Action *> actions(const State *state) = 0;
+        virtual void actions(const State &state, action_sink_t<Action> out) = 0;
 
-        virtual State *successor(const State *state, const Action *action) = 0;
+        virtual void successor(const State &state, const Action &action, State &out) = 0;
 
-        virtual double cost(const State *state, const Action *action) = 0;
+        virtual double cost(const State &state, const Action &action) = 0;
 
-        double heuristic(const State *state) { return 0.0; }
+        virtual double heuristic(const State &) { return 0.0; }
 
         virtual ~Problem() = default;
     };
+
+    // Type-erased adapter exposing a statically dispatched problem through the virtual interface.
+    template<SearchProblem P>
+    class ProblemAdapter final : public Problem<typename P::state_type, typename P::action_type>
+    {
+        using State = typename P::state_type;
+        using Action = typename P::action_type;
+
+        P m_problem;
+
+    public:
+        explicit ProblemAdapter(P problem) : m_problem(std::move(problem)) {}
+
+        State initialState() override { return m_problem.initialState(); }
+
+        bool isGoal(const State &state) override { return m_problem.isGoal(state); }
+
+        void actions(const State &state, action_sink_t<Action> out) override { m_problem.actions(state, out); }
+
+        void successor(const State &state, const Action &action, State &out) override { m_problem.successor(state, action, out); }
+
+        double cost(const State &state, const Action &action) override { return m_problem.cost(state, action); }
+
+        double heuristic(const State &state) override { return m_problem.heuristic(state); }
+    };
 } // search
 
 #endif //CHESS_ENGINE_PROBLEM_H
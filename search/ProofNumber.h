@@ -0,0 +1,316 @@
+#ifndef CHESS_ENGINE_PROOF_NUMBER_H
+#define CHESS_ENGINE_PROOF_NUMBER_H
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "Problem.h"
+#include "Solution.h"
+
+namespace search
+{
+    enum class Proof : unsigned char { Unknown, Proven, Disproven };
+
+    // Compile-time interface of an AND/OR tree to prove. The root and every second ply below it are OR nodes, where
+    // one proven child proves the node; the plies between are AND nodes, which need every child proven. evaluate
+    // settles a node without expanding it where it can, actions lists the children of the rest, and key identifies a
+    // state for the proof table. A node with no actions is disproven at an OR ply and proven at an AND ply.
+    template<typename P>
+    concept ProofProblem = std::copyable<typename P::state_type> && std::default_initializable<typename P::state_type> &&
+                           std::copyable<typename P::action_type> && std::default_initializable<typename P::action_type> &&
+                           requires(P &problem, const typename P::state_type &state, const typename P::action_type &action,
+                                    typename P::state_type &successor, action_sink_t<typename P::action_type> actions)
+                           {
+                               { problem.initialState() } -> std::convertible_to<typename P::state_type>;
+                               { problem.evaluate(state) } -> std::convertible_to<Proof>;
+                               problem.actions(state, actions);
+                               problem.successor(state, action, successor);
+                               { problem.key(state) } -> std::convertible_to<std::uint64_t>;
+                           };
+
+    template<typename Action>
+    struct ProofSolution
+    {
+        Proof proof = Proof::Unknown; // Unknown when the node limit ran out first.
+        std::vector<Action> path{};   // When proven: OR moves that prove, AND moves that hold out longest.
+        Statistics statistics{};
+    };
+
+    // Proof and disproof numbers by (key, remaining depth) in a fixed amount of memory. Two entries per bucket; a
+    // new entry replaces one left by an earlier search if there is one, otherwise the one that took less work to
+    // find, so a table kept from one search to the next does not fill up with entries nothing will ask for again.
+    class ProofTable
+    {
+    public:
+        struct Entry
+        {
+            std::uint64_t key = 0;
+            std::uint32_t phi = 1;
+            std::uint32_t delta = 1;
+            std::uint32_t work = 0; // Nodes expanded below it, so cheap entries give way first.
+            std::int16_t depth = -1;
+            std::uint16_t generation = 0;
+        };
+
+    private:
+        std::unique_ptr<Entry[]> m_entries;
+        std::size_t m_mask; // Over buckets of two entries.
+        std::uint16_t m_generation;
+
+        // Numbers found under one depth limit do not hold under another, so an entry is a (key, depth) pair. Hashing
+        // the depth in as well sends a position's entries from successive iterations to different buckets, where
+        // they do not push each other out.
+        [[nodiscard]] Entry *bucket(std::uint64_t key, int depth) const noexcept
+        {
+            return &m_entries[2 * ((key ^ (std::uint64_t(depth) * 0x9E3779B97F4A7C15)) & m_mask)];
+        }
+
+    public:
+        explicit ProofTable(std::size_t megabytes = 16) : m_entries(), m_mask(0), m_generation(0)
+        {
+            const auto buckets = std::bit_floor(std::max<std::size_t>(1, megabytes * 1024 * 1024 / (2 * sizeof(Entry))));
+            m_entries = std::make_unique<Entry[]>(2 * buckets);
+            m_mask = buckets - 1;
+        }
+
+        [[nodiscard]] const Entry *find(std::uint64_t key, int depth) const noexcept
+        {
+            const auto *entries = bucket(key, depth);
+            for (int i = 0; i < 2; i++)
+                if (entries[i].key == key && entries[i].depth == depth) return &entries[i];
+            return nullptr;
+        }
+
+        void store(Entry entry) noexcept
+        {
+            auto *entries = bucket(entry.key, entry.depth);
+            auto stale = [this](const Entry &old) { return old.generation != m_generation; };
+            auto *slot = entries[0].key == entry.key && entries[0].depth == entry.depth ? &entries[0]
+                       : entries[1].key == entry.key && entries[1].depth == entry.depth ? &entries[1]
+                       : stale(entries[0]) != stale(entries[1]) ? (stale(entries[0]) ? &entries[0] : &entries[1])
+                       : entries[0].work <= entries[1].work ? &entries[0] : &entries[1];
+            entry.generation = m_generation;
+            *slot = entry;
+        }
+
+        // Marks everything stored so far as left by an earlier search.
+        void age() noexcept { m_generation++; }
+
+        void clear() noexcept { std::fill_n(m_entries.get(), 2 * (m_mask + 1), Entry()); }
+
+        [[nodiscard]] std::size_t bytesReserved() const noexcept { return 2 * (m_mask + 1) * sizeof(Entry); }
+    };
+
+    // Depth-first proof-number search (df-pn): the best-first order of proof-number search, always expanding a most
+    // proving node, reached depth first under thresholds so that memory is the proof table rather than a tree. Node
+    // numbers are kept from the side to move's view: phi is its proof number, delta its disproof number, so both
+    // kinds of ply run the same code. Depth is a hard limit in plies, and a node still open at it is disproven.
+    //
+    // Like IDAStar, states and action buffers are one per ply and reused, so nothing is allocated per expansion once
+    // the deepest ply has been reached. A state stays where it is while its ply is searched and successor() is always
+    // given the one in its ply's slot, so a successor may point at the state it came from.
+    template<ProofProblem P>
+    class DfPn
+    {
+        using State = typename P::state_type;
+        using Action = typename P::action_type;
+        using Entry = ProofTable::Entry;
+
+        static constexpr const std::uint32_t s_infinity = 1u << 30;
+
+        P &m_problem;
+        ProofTable m_table;
+        std::uint64_t m_nodeLimit; // 0 for none.
+        bool m_aborted;
+        Statistics m_statistics;
+
+        // One slot per ply. mid() holds references into its own ply's slots across the recursive call that grows
+        // the deques by a ply, and a deque appends without moving the elements it already has.
+        std::deque<State> m_states;
+        std::deque<std::vector<Action>> m_actions;
+        std::deque<std::vector<Entry>> m_children;
+
+        [[nodiscard]] static std::uint32_t saturate(std::uint64_t value) noexcept { return static_cast<std::uint32_t>(std::min<std::uint64_t>(value, s_infinity)); }
+
+        [[nodiscard]] Entry lookup(std::uint64_t key, int depth) const noexcept
+        {
+            const auto *entry = m_table.find(key, depth);
+            return entry ? *entry : Entry{key, 1, 1, 0, static_cast<std::int16_t>(depth), 0};
+        }
+
+        // Settled without children: the side to move wins (phi 0) or loses (delta 0).
+        [[nodiscard]] static Entry settled(std::uint64_t key, int depth, bool sideToMoveWins) noexcept
+        {
+            const auto shortDepth = static_cast<std::int16_t>(depth);
+            return sideToMoveWins ? Entry{key, 0, s_infinity, 1, shortDepth, 0} : Entry{key, s_infinity, 0, 1, shortDepth, 0};
+        }
+
+        void grow(std::size_t ply)
+        {
+            while (m_states.size() <= ply + 1) m_states.emplace_back();
+            while (m_actions.size() <= ply) m_actions.emplace_back();
+            while (m_children.size() <= ply) m_children.emplace_back();
+        }
+
+        // Searches the state at ply until its phi reaches thresholdPhi or its delta thresholdDelta, then stores and
+        // returns its numbers.
+        Entry mid(std::size_t ply, int depth, std::uint32_t thresholdPhi, std::uint32_t thresholdDelta)
+        {
+            grow(ply);
+            const auto &state = m_states[ply];
+            const auto key = m_problem.key(state);
+            const bool orNode = ply % 2 == 0;
+
+            auto proof = m_problem.evaluate(state);
+            auto &actions = m_actions[ply];
+            if (proof == Proof::Unknown && depth == 0) proof = Proof::Disproven;
+            if (proof == Proof::Unknown)
+            {
+                actions.clear();
+                m_problem.actions(state, std::back_inserter(actions));
+                if (actions.empty()) proof = orNode ? Proof::Disproven : Proof::Proven;
+            }
+            if (proof != Proof::Unknown)
+            {
+                const auto entry = settled(key, depth, (proof == Proof::Proven) == orNode);
+                m_table.store(entry);
+                return entry;
+            }
+
+            // The children's numbers are read from the table once and then kept here, so one pushed out of the
+            // table by its own subtree is not searched again from nothing.
+            const auto firstExpansion = m_statistics.expanded++;
+            auto &children = m_children[ply];
+            children.clear();
+            for (const auto &action: actions)
+            {
+                m_problem.successor(state, action, m_states[ply + 1]);
+                children.push_back(lookup(m_problem.key(m_states[ply + 1]), depth - 1));
+            }
+            m_statistics.generated += actions.size();
+
+            Entry node{key, 0, 0, 0, static_cast<std::int16_t>(depth), 0};
+            while (true)
+            {
+                // phi is the least delta of a child, delta the sum of the children's phi.
+                std::size_t best = 0;
+                std::uint32_t bestDelta = s_infinity, secondDelta = s_infinity;
+                std::uint64_t sumPhi = 0;
+                for (std::size_t i = 0; i < children.size(); i++)
+                {
+                    const auto &child = children[i];
+                    sumPhi += child.phi;
+                    if (child.delta < bestDelta)
+                    {
+                        secondDelta = bestDelta;
+                        bestDelta = child.delta;
+                        best = i;
+                    }
+                    else if (child.delta < secondDelta) secondDelta = child.delta;
+                }
+                node.phi = bestDelta;
+                node.delta = saturate(sumPhi);
+                if (node.phi >= thresholdPhi || node.delta >= thresholdDelta || m_aborted) break;
+                if (m_nodeLimit && m_statistics.expanded >= m_nodeLimit)
+                {
+                    m_aborted = true;
+                    break;
+                }
+
+                const auto childPhi = children[best].phi;
+                const auto childThresholdPhi = thresholdDelta >= s_infinity ? s_infinity : saturate(std::uint64_t(thresholdDelta) + childPhi - node.delta);
+                const auto childThresholdDelta = std::min<std::uint32_t>(thresholdPhi, secondDelta >= s_infinity ? s_infinity : secondDelta + 1);
+                m_problem.successor(state, actions[best], m_states[ply + 1]);
+                children[best] = mid(ply + 1, depth - 1, childThresholdPhi, childThresholdDelta);
+            }
+
+            node.work = saturate(m_statistics.expanded - firstExpansion);
+            m_table.store(node);
+            return node;
+        }
+
+        // Follows a proof from the root: at an OR ply a proven child, the cheapest one, at an AND ply the child whose
+        // proof took the most work, standing in for the longest defence. A child the table has lost is searched again.
+        [[nodiscard]] std::vector<Action> line(int depth)
+        {
+            std::vector<Action> path;
+            for (std::size_t ply = 0;; ply++, depth--)
+            {
+                grow(ply);
+                const auto &state = m_states[ply];
+                if (depth == 0 || m_problem.evaluate(state) != Proof::Unknown) break;
+
+                auto &actions = m_actions[ply];
+                actions.clear();
+                m_problem.actions(state, std::back_inserter(actions));
+
+                const bool orNode = ply % 2 == 0;
+                std::size_t chosen = actions.size();
+                std::uint32_t chosenWork = 0;
+                for (std::size_t i = 0; i < actions.size(); i++)
+                {
+                    m_problem.successor(state, actions[i], m_states[ply + 1]);
+                    auto child = lookup(m_problem.key(m_states[ply + 1]), depth - 1);
+                    if (child.phi != 0 && child.delta != 0) child = mid(ply + 1, depth - 1, s_infinity, s_infinity);
+                    // Proven for the root's side: the child's side to move has lost at an OR ply, won at an AND ply.
+                    const bool proving = orNode ? child.delta == 0 : child.phi == 0;
+                    if (!proving) continue;
+                    if (chosen == actions.size() || (orNode ? child.work < chosenWork : child.work > chosenWork))
+                    {
+                        chosen = i;
+                        chosenWork = child.work;
+                    }
+                }
+                if (chosen == actions.size()) break;
+
+                path.push_back(actions[chosen]);
+                m_problem.successor(state, actions[chosen], m_states[ply + 1]);
+            }
+            return path;
+        }
+
+    public:
+        explicit DfPn(P &problem, std::size_t megabytes = 16, std::uint64_t nodeLimit = 0)
+                : m_problem(problem), m_table(megabytes), m_nodeLimit(nodeLimit), m_aborted(false), m_statistics(), m_states(), m_actions(),
+                  m_children() {}
+
+        // Whether the root can be proven within depth plies. The table is kept between calls, so searching the same
+        // root again at a greater depth reuses what the shallower ones found.
+        ProofSolution<Action> search(int depth)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            m_statistics = Statistics();
+            m_aborted = false;
+            m_table.age();
+            grow(0);
+            m_states.front() = m_problem.initialState();
+
+            ProofSolution<Action> solution;
+            const auto root = mid(0, depth, s_infinity, s_infinity);
+            if (root.phi == 0) solution.proof = Proof::Proven;
+            else if (root.delta == 0) solution.proof = Proof::Disproven;
+            if (solution.proof == Proof::Proven) solution.path = line(depth);
+
+            std::size_t bufferBytes = m_states.size() * sizeof(State);
+            for (std::size_t i = 0; i < m_actions.size(); i++)
+                bufferBytes += m_actions[i].capacity() * sizeof(Action) + m_children[i].capacity() * sizeof(Entry);
+            m_statistics.peakMemory = m_table.bytesReserved() + bufferBytes;
+            m_statistics.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            solution.statistics = m_statistics;
+            return solution;
+        }
+
+        void clear() noexcept { m_table.clear(); }
+    };
+} // search
+
+#endif //CHESS_ENGINE_PROOF_NUMBER_H
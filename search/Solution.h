@@ -0,0 +1,33 @@
+#ifndef CHESS_ENGINE_SOLUTION_H
+#define CHESS_ENGINE_SOLUTION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace search
+{
+    struct Statistics
+    {
+        std::uint64_t expanded = 0;
+        std::uint64_t generated = 0;
+        std::size_t peakMemory = 0; // Bytes held by the search's own structures, excluding the problem.
+        double seconds = 0.0;
+
+        [[nodiscard]] double expansionsPerSecond() const noexcept
+        {
+            return seconds > 0.0 ? static_cast<double>(expanded) / seconds : 0.0;
+        }
+    };
+
+    template<typename Action>
+    struct Solution
+    {
+        bool found = false;
+        std::vector<Action> path{};
+        double cost = 0.0;
+        Statistics statistics{};
+    };
+} // search
+
+#endif //CHESS_ENGINE_SOLUTION_H
@@ -0,0 +1,82 @@
+#ifndef CHESS_ENGINE_STATE_TABLE_H
+#define CHESS_ENGINE_STATE_TABLE_H
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "NodeArena.h"
+
+namespace search
+{
+    // Maps each generated state to its node in the arena, keyed on the state's hash. Open addressing with linear
+    // probing; the arena holds the states themselves, so a slot is only a hash and an index. Whether the node is still
+    // open or already closed is the open list's business.
+    template<typename State, typename Action, typename Hash = std::hash<State>>
+    class StateTable
+    {
+        struct Slot
+        {
+            std::size_t hash;
+            node_index_t node;
+        };
+
+        std::vector<Slot> m_slots;
+        std::size_t m_size;
+        [[no_unique_address]] Hash m_hasher;
+
+        void grow()
+        {
+            auto old = std::move(m_slots);
+            m_slots.assign(old.empty() ? 1024 : old.size() * 2, Slot{0, NoNode});
+            for (const auto &slot: old)
+                if (slot.node != NoNode)
+                    place(slot);
+        }
+
+        void place(const Slot &slot) noexcept
+        {
+            const auto mask = m_slots.size() - 1;
+            auto i = slot.hash & mask;
+            while (m_slots[i].node != NoNode) i = (i + 1) & mask;
+            m_slots[i] = slot;
+        }
+
+    public:
+        explicit StateTable(Hash hasher = Hash()) : m_slots(), m_size(0), m_hasher(std::move(hasher)) {}
+
+        [[nodiscard]] std::size_t hash(const State &state) const { return m_hasher(state); }
+
+        [[nodiscard]] node_index_t find(const NodeArena<State, Action> &arena, const State &state, std::size_t hash) const
+        {
+            if (m_slots.empty()) return NoNode;
+
+            const auto mask = m_slots.size() - 1;
+            for (auto i = hash & mask; m_slots[i].node != NoNode; i = (i + 1) & mask)
+                if (m_slots[i].hash == hash && arena[m_slots[i].node].state() == state)
+                    return m_slots[i].node;
+
+            return NoNode;
+        }
+
+        // The state must not be in the table yet.
+        void insert(std::size_t hash, node_index_t node)
+        {
+            if (2 * (m_size + 1) > m_slots.size()) grow();
+            place(Slot{hash, node});
+            m_size++;
+        }
+
+        [[nodiscard]] std::size_t size() const noexcept { return m_size; }
+
+        void clear() noexcept
+        {
+            m_slots.clear();
+            m_size = 0;
+        }
+
+        [[nodiscard]] std::size_t bytesReserved() const noexcept { return m_slots.capacity() * sizeof(Slot); }
+    };
+} // search
+
+#endif //CHESS_ENGINE_STATE_TABLE_H
@@ -0,0 +1,62 @@
+// Instantiates every search in search/ on small problems, so the headers are compiled with the project's warnings
+// even where nothing in the engine uses them yet. Built as an object library; there is nothing to run.
+
+#include <cstdint>
+
+#include "AStar.h"
+#include "IDAStar.h"
+#include "ParallelAStar.h"
+#include "Problem.h"
+#include "ProofNumber.h"
+
+namespace
+{
+    // From one corner of an 8x8 grid to the other, a cell is its index.
+    struct Grid
+    {
+        using state_type = int;
+        using action_type = int;
+
+        [[nodiscard]] int initialState() const noexcept { return 0; }
+
+        [[nodiscard]] bool isGoal(int cell) const noexcept { return cell == 63; }
+
+        void actions(int cell, search::action_sink_t<int> out) const
+        {
+            if (cell % 8 < 7) *out++ = 1;
+            if (cell / 8 < 7) *out++ = 8;
+        }
+
+        void successor(int cell, int step, int &out) const noexcept { out = cell + step; }
+
+        [[nodiscard]] double cost(int, int) const noexcept { return 1.0; }
+
+        [[nodiscard]] double heuristic(int cell) const noexcept { return 14 - cell % 8 - cell / 8; }
+    };
+
+    // Take one or two stones; whoever cannot move loses.
+    struct Nim
+    {
+        using state_type = int;
+        using action_type = int;
+
+        [[nodiscard]] int initialState() const noexcept { return 7; }
+
+        [[nodiscard]] search::Proof evaluate(int) const noexcept { return search::Proof::Unknown; }
+
+        void actions(int stones, search::action_sink_t<int> out) const
+        {
+            for (int take = 1; take <= 2 && take <= stones; take++) *out++ = take;
+        }
+
+        void successor(int stones, int take, int &out) const noexcept { out = stones - take; }
+
+        [[nodiscard]] std::uint64_t key(int stones) const noexcept { return static_cast<std::uint64_t>(stones); }
+    };
+}
+
+template class search::AStar<Grid>;
+template class search::IDAStar<Grid>;
+template class search::ParallelAStar<Grid>;
+template class search::ProblemAdapter<Grid>;
+template class search::DfPn<Nim>;
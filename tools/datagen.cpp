@@ -0,0 +1,203 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "engine/Match.h"
+#include "engine/TrainingData.h"
+
+namespace tools
+{
+    struct Settings
+    {
+        std::string output = "training.bin";
+        std::uint64_t games = 10000;
+        unsigned concurrency = std::max(1u, std::thread::hardware_concurrency());
+        std::uint64_t nodes = 5000;
+        int randomPlies = 8;
+        engine::score_t maxOpeningScore = 400;
+        std::uint64_t seed = 1;
+        std::size_t hash = 2;
+    };
+
+    void usage(const char *program)
+    {
+        std::cerr << "usage: " << program << " [--output file] [--games N] [--concurrency N] [--nodes N]\n"
+                  << "       [--random-plies N] [--max-opening-score cp] [--seed N] [--hash MB]\n";
+    }
+
+    Settings parse(int argc, char *argv[])
+    {
+        Settings settings;
+        for (int i = 1; i < argc; i++)
+        {
+            const std::string_view flag = argv[i];
+            if (i + 1 >= argc) throw std::invalid_argument("missing value for " + std::string(flag));
+            const std::string value = argv[++i];
+
+            if (flag == "--output") settings.output = value;
+            else if (flag == "--games") settings.games = std::stoull(value);
+            else if (flag == "--concurrency") settings.concurrency = std::max(1u, static_cast<unsigned>(std::stoul(value)));
+            else if (flag == "--nodes") settings.nodes = std::stoull(value);
+            else if (flag == "--random-plies") settings.randomPlies = std::stoi(value);
+            else if (flag == "--max-opening-score") settings.maxOpeningScore = std::stoi(value);
+            else if (flag == "--seed") settings.seed = std::stoull(value);
+            else if (flag == "--hash") settings.hash = std::stoul(value);
+            else throw std::invalid_argument("unknown flag " + std::string(flag));
+        }
+        return settings;
+    }
+
+    // Plays random legal moves from the starting position; empty if the game ended on the way.
+    std::string randomOpening(std::mt19937_64 &rng, int plies)
+    {
+        chess::Board board(std::string("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"));
+        for (int ply = 0; ply < plies; ply++)
+        {
+            chess::MoveList moves, legal;
+            board.generate(moves);
+            for (const auto move: moves)
+            {
+                chess::Board::Undo undo;
+                if (!board.make(move, undo)) continue;
+                legal.push(move);
+                board.unmake(move, undo);
+            }
+            if (legal.empty()) return {};
+
+            chess::Board::Undo undo;
+            (void) board.make(legal[static_cast<unsigned>(rng() % legal.size())], undo);
+        }
+        return board.fen();
+    }
+
+    // Keeps quiet positions only: not in check, not decided by a capture or promotion, not a known mate. Their
+    // static scores are the ones an evaluation can learn from.
+    void label(const engine::GameRecord &game, std::vector<engine::PackedPosition> &out)
+    {
+        const std::uint8_t result = game.result == chess::Result::WhiteWin ? 2 : game.result == chess::Result::BlackWin ? 0 : 1;
+        chess::Board board(game.startFen);
+        for (std::size_t i = 0; i < game.moves.size(); i++)
+        {
+            const auto move = game.moves[i];
+            const auto score = game.scores[i];
+            const bool tactical = board.pieceAt(move.to()) != chess::Piece::None || move.promotion() != chess::Promotion::None ||
+                                  (board.enPassantSquare() >> move.to() & 1 &&
+                                   (board.pieceAt(move.from()) == chess::Piece::WPawn || board.pieceAt(move.from()) == chess::Piece::BPawn));
+            if (!tactical && !board.inCheck() && !engine::isMate(score))
+                out.push_back(engine::PackedPosition::pack(board, board.turn() == chess::Color::White ? score : -score, result));
+
+            chess::Board::Undo undo;
+            (void) board.make(move, undo);
+        }
+    }
+
+    class Generator
+    {
+        static constexpr const std::size_t s_batchSize = 1 << 14;
+
+        const Settings &m_settings;
+        engine::TrainingWriter m_writer;
+        std::atomic<std::uint64_t> m_nextGame;
+        std::atomic<std::uint64_t> m_gamesPlayed;
+        std::atomic<std::uint64_t> m_positions;
+        std::atomic<bool> m_stop;
+
+        void worker()
+        {
+            engine::PlayerConfig config{"datagen"};
+            config.hash = m_settings.hash;
+            engine::TimeControl tc;
+            tc.nodes = m_settings.nodes;
+            const engine::Adjudication adjudication;
+
+            std::vector<engine::PackedPosition> batch;
+            batch.reserve(s_batchSize);
+            while (true)
+            {
+                const auto index = m_nextGame.fetch_add(1);
+                if (index >= m_settings.games) break;
+
+                // Seeded per game, so a run can be reproduced whatever the thread count.
+                std::mt19937_64 rng(m_settings.seed * 0x9E3779B97F4A7C15 + index);
+                const auto opening = randomOpening(rng, m_settings.randomPlies);
+                if (opening.empty()) continue;
+
+                // Scored with the same budget as a move before the game is played, so a lopsided opening costs one
+                // search rather than a whole game. A fresh player keeps the verdict independent of earlier games.
+                engine::Limits limits;
+                limits.nodes = m_settings.nodes;
+                if (std::abs(engine::Player(config).think(chess::Board(opening), limits).score) > m_settings.maxOpeningScore) continue;
+
+                const auto game = engine::playGame(opening, config, config, tc, adjudication, m_stop);
+                if (game.scores.empty()) continue;
+
+                const auto before = batch.size();
+                label(game, batch);
+                m_positions.fetch_add(batch.size() - before, std::memory_order_relaxed);
+                m_gamesPlayed.fetch_add(1, std::memory_order_relaxed);
+                if (batch.size() >= s_batchSize)
+                {
+                    m_writer.submit(std::move(batch));
+                    batch = {};
+                    batch.reserve(s_batchSize);
+                }
+            }
+            m_writer.submit(std::move(batch));
+        }
+
+    public:
+        explicit Generator(const Settings &settings)
+                : m_settings(settings), m_writer(settings.output), m_nextGame(0), m_gamesPlayed(0), m_positions(0), m_stop(false) {}
+
+        void run()
+        {
+            const auto start = std::chrono::steady_clock::now();
+            std::vector<std::jthread> threads;
+            for (unsigned i = 0; i < m_settings.concurrency; i++)
+                threads.emplace_back([this] { worker(); });
+
+            const auto report = [&]
+            {
+                const auto minutes = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / 60.0;
+                const auto positions = m_positions.load();
+                std::cout << "games " << m_gamesPlayed.load() << ", positions " << positions << ", positions/min "
+                          << static_cast<std::uint64_t>(minutes > 0 ? double(positions) / minutes : 0) << std::endl;
+            };
+
+            auto lastReport = start;
+            while (m_nextGame.load() < m_settings.games)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                if (std::chrono::steady_clock::now() - lastReport >= std::chrono::seconds(5))
+                {
+                    lastReport = std::chrono::steady_clock::now();
+                    report();
+                }
+            }
+            threads.clear();
+            report();
+        }
+    };
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        const auto settings = tools::parse(argc, argv);
+        tools::Generator(settings).run();
+    }
+    catch (const std::exception &error)
+    {
+        std::cerr << error.what() << '\n';
+        tools::usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+}
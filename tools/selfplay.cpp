@@ -0,0 +1,209 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "engine/Match.h"
+#include "engine/Sprt.h"
+
+namespace tools
+{
+    struct Settings
+    {
+        engine::PlayerConfig engines[2]{{"A"}, {"B"}};
+        std::vector<std::string> openings{};
+        engine::TimeControl timeControl{};
+        engine::Adjudication adjudication{};
+        engine::Sprt sprt{};
+        bool useSprt = false;
+        std::uint64_t games = 1000;
+        unsigned concurrency = std::max(1u, std::thread::hardware_concurrency());
+    };
+
+    void usage(const char *program)
+    {
+        std::cerr << "usage: " << program << " --engine [name=N] [hash=MB] [Option=value...] --engine ...\n"
+                  << "       [--openings file.epd] [--games N] [--concurrency N]\n"
+                  << "       [--tc seconds+increment | --nodes N | --depth N]\n"
+                  << "       [--sprt elo0=0 elo1=5 alpha=0.05 beta=0.05]\n"
+                  << "       [--resign score plies] [--draw score plies fromMove] [--maxplies N]\n";
+    }
+
+    // Arguments after a flag up to the next "--".
+    std::vector<std::string_view> values(int &i, int argc, char *argv[])
+    {
+        std::vector<std::string_view> result;
+        while (i + 1 < argc && std::string_view(argv[i + 1]).substr(0, 2) != "--")
+            result.emplace_back(argv[++i]);
+        return result;
+    }
+
+    Settings parse(int argc, char *argv[])
+    {
+        Settings settings;
+        int engineCount = 0;
+        for (int i = 1; i < argc; i++)
+        {
+            const std::string_view flag = argv[i];
+            const auto args = values(i, argc, argv);
+            const auto number = [&](std::size_t index) { return index < args.size() ? std::stod(std::string(args[index])) : throw std::invalid_argument(std::string(flag)); };
+
+            if (flag == "--engine")
+            {
+                if (engineCount == 2) throw std::invalid_argument("at most two engines");
+                auto &config = settings.engines[engineCount++];
+                for (const auto arg: args)
+                {
+                    const auto equals = arg.find('=');
+                    const auto key = arg.substr(0, equals), value = equals == std::string_view::npos ? std::string_view() : arg.substr(equals + 1);
+                    if (key == "name") config.name = value;
+                    else if (key == "hash") config.hash = std::stoul(std::string(value));
+                    else if (!config.options.set(key, value)) throw std::invalid_argument("unknown engine option " + std::string(arg));
+                }
+            }
+            else if (flag == "--openings") settings.openings = engine::loadOpenings(std::string(args.at(0)));
+            else if (flag == "--games") settings.games = static_cast<std::uint64_t>(number(0));
+            else if (flag == "--concurrency") settings.concurrency = std::max(1u, static_cast<unsigned>(number(0)));
+            else if (flag == "--tc") settings.timeControl = engine::TimeControl::parse(args.at(0));
+            else if (flag == "--nodes") settings.timeControl.nodes = static_cast<std::uint64_t>(number(0));
+            else if (flag == "--depth") settings.timeControl.depth = static_cast<int>(number(0));
+            else if (flag == "--resign")
+            {
+                settings.adjudication.resignScore = static_cast<engine::score_t>(number(0));
+                settings.adjudication.resignPlies = static_cast<int>(number(1));
+            }
+            else if (flag == "--draw")
+            {
+                settings.adjudication.drawScore = static_cast<engine::score_t>(number(0));
+                settings.adjudication.drawPlies = static_cast<int>(number(1));
+                settings.adjudication.drawFromMove = static_cast<int>(number(2));
+            }
+            else if (flag == "--maxplies") settings.adjudication.maxPlies = static_cast<int>(number(0));
+            else if (flag == "--sprt")
+            {
+                settings.useSprt = true;
+                for (const auto arg: args)
+                {
+                    const auto equals = arg.find('=');
+                    const auto key = arg.substr(0, equals);
+                    const auto value = std::stod(std::string(arg.substr(equals + 1)));
+                    if (key == "elo0") settings.sprt.elo0 = value;
+                    else if (key == "elo1") settings.sprt.elo1 = value;
+                    else if (key == "alpha") settings.sprt.alpha = value;
+                    else if (key == "beta") settings.sprt.beta = value;
+                    else throw std::invalid_argument("unknown SPRT parameter " + std::string(arg));
+                }
+            }
+            else throw std::invalid_argument("unknown flag " + std::string(flag));
+        }
+
+        if (settings.openings.empty()) settings.openings.emplace_back("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+        return settings;
+    }
+
+    // Runs games on a fixed set of threads, one search thread per game. Each opening is played twice with colours
+    // reversed so neither engine profits from a lopsided opening.
+    class Tournament
+    {
+        const Settings &m_settings;
+        std::atomic<std::uint64_t> m_nextGame;
+        std::atomic<bool> m_stop;
+        std::mutex m_mutex;
+        engine::MatchScore m_score;
+
+        void report(std::uint64_t index, bool firstIsWhite, const engine::GameRecord &game)
+        {
+            const std::scoped_lock lock(m_mutex);
+            const bool draw = game.result == chess::Result::Draw;
+            const bool firstWon = !draw && (game.result == chess::Result::WhiteWin) == firstIsWhite;
+            if (draw) m_score.draws++;
+            else if (firstWon) m_score.wins++;
+            else m_score.losses++;
+
+            const auto &white = m_settings.engines[firstIsWhite ? 0 : 1].name, &black = m_settings.engines[firstIsWhite ? 1 : 0].name;
+            std::cout << "Game " << index + 1 << ": " << white << " vs " << black << ' '
+                      << (draw ? "1/2-1/2" : game.result == chess::Result::WhiteWin ? "1-0" : "0-1") << " (" << engine::terminationName(game.termination)
+                      << ", " << game.moves.size() << " plies)\n"
+                      << "Score of " << m_settings.engines[0].name << " vs " << m_settings.engines[1].name << ": " << m_score.wins << " - "
+                      << m_score.losses << " - " << m_score.draws << " [" << std::fixed << std::setprecision(3) << m_score.score() << "] "
+                      << std::setprecision(1) << "Elo " << m_score.elo() << " +/- " << m_score.eloError();
+            if (m_settings.useSprt)
+                std::cout << std::setprecision(2) << ", LLR " << m_settings.sprt.llr(m_score) << " (" << m_settings.sprt.lowerBound() << ", "
+                          << m_settings.sprt.upperBound() << ')';
+            std::cout << std::defaultfloat << std::endl;
+
+            if (m_settings.useSprt && m_settings.sprt.decide(m_score) != engine::Sprt::Decision::Continue)
+                m_stop.store(true);
+        }
+
+        void worker()
+        {
+            while (!m_stop.load())
+            {
+                const auto index = m_nextGame.fetch_add(1);
+                if (index >= m_settings.games) return;
+
+                const bool firstIsWhite = index % 2 == 0;
+                const auto &opening = m_settings.openings[(index / 2) % m_settings.openings.size()];
+                const auto &white = m_settings.engines[firstIsWhite ? 0 : 1], &black = m_settings.engines[firstIsWhite ? 1 : 0];
+                const auto game = engine::playGame(opening, white, black, m_settings.timeControl, m_settings.adjudication, m_stop);
+                if (game.termination != engine::Termination::Aborted) report(index, firstIsWhite, game);
+            }
+        }
+
+    public:
+        explicit Tournament(const Settings &settings) : m_settings(settings), m_nextGame(0), m_stop(false), m_mutex(), m_score() {}
+
+        engine::MatchScore run()
+        {
+            {
+                std::vector<std::jthread> threads;
+                for (unsigned i = 0; i < m_settings.concurrency; i++)
+                    threads.emplace_back([this] { worker(); });
+            }
+            return m_score;
+        }
+    };
+}
+
+int main(int argc, char *argv[])
+{
+    tools::Settings settings;
+    try
+    {
+        settings = tools::parse(argc, argv);
+    }
+    catch (const std::exception &error)
+    {
+        std::cerr << error.what() << '\n';
+        tools::usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const auto score = tools::Tournament(settings).run();
+    std::cout << "Finished " << score.games() << " games";
+    if (settings.useSprt)
+    {
+        switch (settings.sprt.decide(score))
+        {
+            case engine::Sprt::Decision::AcceptH1:
+                std::cout << ", SPRT accepts H1";
+                break;
+            case engine::Sprt::Decision::AcceptH0:
+                std::cout << ", SPRT accepts H0";
+                break;
+            case engine::Sprt::Decision::Continue:
+            default:
+                std::cout << ", SPRT inconclusive";
+                break;
+        }
+    }
+    std::cout << '\n';
+}
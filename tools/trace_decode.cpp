@@ -0,0 +1,122 @@
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "engine/Tracer.h"
+
+namespace tools
+{
+    struct TraceNode
+    {
+        engine::TraceRecord record;
+        std::vector<TraceNode> children;
+    };
+
+    constexpr std::string_view nodeTypeName(engine::NodeType type) noexcept
+    {
+        switch (type)
+        {
+            case engine::NodeType::Pv:
+                return "pv";
+            case engine::NodeType::Cut:
+                return "cut";
+            case engine::NodeType::All:
+                return "all";
+            case engine::NodeType::Quiescence:
+                return "qs";
+            default:
+                return "?";
+        }
+    }
+
+    constexpr std::string_view decisionName(engine::Decision decision) noexcept
+    {
+        switch (decision)
+        {
+            case engine::Decision::Searched:
+                return "";
+            case engine::Decision::TableCutoff:
+                return " tt-cutoff";
+            case engine::Decision::Draw:
+                return " draw";
+            case engine::Decision::Mate:
+                return " mate";
+            case engine::Decision::Stalemate:
+                return " stalemate";
+            case engine::Decision::StandPat:
+                return " stand-pat";
+            case engine::Decision::NullMove:
+                return " null-move";
+            case engine::Decision::Futility:
+                return " futility";
+            case engine::Decision::Razoring:
+                return " razoring";
+            default:
+                return " ?";
+        }
+    }
+
+    // Records are in post-order, so each one adopts everything collected one ply below it since the last record at
+    // its own ply. Nodes whose parent was overwritten in the ring buffer come out as extra roots.
+    std::vector<TraceNode> buildTree(const std::vector<engine::TraceRecord> &records)
+    {
+        std::vector<std::vector<TraceNode>> pending(engine::MaxPly + 1);
+        for (const auto &record: records)
+        {
+            // The search records no deeper than MaxPly - 1, so a record's own level, its children's level and, past
+            // the root, its parent's level all exist in pending; anything deeper is a corrupt file.
+            if (record.ply + 1u >= pending.size())
+                throw std::runtime_error("corrupt trace: record at ply " + std::to_string(record.ply) + " is deeper than the search goes");
+
+            TraceNode node{record, std::move(pending[record.ply + 1u])};
+            pending[record.ply + 1u].clear();
+            pending[record.ply].push_back(std::move(node));
+        }
+
+        std::vector<TraceNode> roots;
+        for (auto &level: pending)
+            for (auto &node: level)
+                roots.push_back(std::move(node));
+        return roots;
+    }
+
+    void print(const TraceNode &node, int maxPly, std::ostream &out)
+    {
+        const auto &r = node.record;
+        out << std::string(2u * r.ply, ' ') << chess::Move::fromData(r.move).uci() << ' ' << nodeTypeName(r.type) << " d" << int(r.depth)
+            << " [" << r.alpha << ", " << r.beta << "] " << r.score << decisionName(r.decision) << '\n';
+
+        if (r.ply >= maxPly) return;
+        for (const auto &child: node.children)
+            print(child, maxPly, out);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: " << argv[0] << " <trace file> [max ply]\n";
+        return EXIT_FAILURE;
+    }
+
+    const int maxPly = argc > 2 ? std::stoi(argv[2]) : engine::MaxPly;
+    try
+    {
+        const auto threads = engine::Tracer::read(argv[1]);
+        for (std::size_t i = 0; i < threads.size(); i++)
+        {
+            std::cout << "thread " << i << ": " << threads[i].size() << " records\n";
+            for (const auto &root: tools::buildTree(threads[i]))
+                tools::print(root, maxPly, std::cout);
+        }
+    }
+    catch (const std::runtime_error &error)
+    {
+        std::cerr << error.what() << '\n';
+        return EXIT_FAILURE;
+    }
+}